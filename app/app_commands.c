@@ -1,9 +1,26 @@
 #include "app_commands.h"
 #include "cli.h"
 #include "scheduler.h"
+#include "mutex.h"
+#include "queue.h"
 #include "stm32_alloc.h"
 #include "systick.h"
 #include "utils.h"
+#if KERNEL_BENCH
+#include "bench.h"
+#endif
+#if KERNEL_TRACE
+#include "trace.h"
+#endif
+#if PROFILER
+#include "profiler.h"
+#endif
+#if TASK_WATCHDOG
+#include "watchdog.h"
+#endif
+#if STACK_PROFILE
+#include "stack_profile.h"
+#endif
 
 /* Forward declarations */
 static int cmd_heap_stats_handler(int argc, char **argv);
@@ -11,6 +28,35 @@ static int cmd_task_list_handler(int argc, char **argv);
 static int cmd_uptime_handler(int argc, char **argv);
 static int cmd_kill_handler(int argc, char **argv);
 static int cmd_reboot_handler(int argc, char **argv);
+static int cmd_mutex_handler(int argc, char **argv);
+static int cmd_queues_handler(int argc, char **argv);
+#if STACK_WATERMARK
+static int cmd_stacks_handler(int argc, char **argv);
+#endif
+#if CONTEXT_SWITCH_PROFILING
+static int cmd_cswitch_handler(int argc, char **argv);
+#endif
+#if SCHEDULER_EDF
+static int cmd_edf_handler(int argc, char **argv);
+#endif
+#if SCHEDULER_CPU_STATS
+static int cmd_top_handler(int argc, char **argv);
+#endif
+#if KERNEL_TRACE
+static int cmd_trace_handler(int argc, char **argv);
+#endif
+#if PROFILER
+static int cmd_prof_handler(int argc, char **argv);
+#endif
+#if TASK_WATCHDOG
+static int cmd_watchdog_handler(int argc, char **argv);
+#endif
+#if STACK_PROFILE
+static int cmd_stackfit_handler(int argc, char **argv);
+#endif
+#if KERNEL_BENCH
+static int cmd_bench_handler(int argc, char **argv);
+#endif
 
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
 /******************* For heap test *******************/
@@ -63,7 +109,7 @@ static const cli_command_t task_list_cmd = {
 
 static const cli_command_t uptime_cmd = {
     .name = "uptime",
-    .help = "How long the system is up",
+    .help = "How long the system is up, load averages and ready-queue length",
     .handler = cmd_uptime_handler
 };
 
@@ -79,6 +125,90 @@ static const cli_command_t reboot_cmd = {
     .handler = cmd_reboot_handler
 };
 
+static const cli_command_t mutex_cmd = {
+    .name = "mutex",
+    .help = "List mutexes with owner and contention statistics",
+    .handler = cmd_mutex_handler
+};
+
+static const cli_command_t queues_cmd = {
+    .name = "queues",
+    .help = "List message queues with fill level and high-water mark",
+    .handler = cmd_queues_handler
+};
+
+#if STACK_WATERMARK
+static const cli_command_t stacks_cmd = {
+    .name = "stacks",
+    .help = "Per-task stack size, current use and high-water mark",
+    .handler = cmd_stacks_handler
+};
+#endif
+
+#if CONTEXT_SWITCH_PROFILING
+static const cli_command_t cswitch_cmd = {
+    .name = "cswitch",
+    .help = "Context switch cycles: cswitch [fpu] (fpu runs a 1s float load)",
+    .handler = cmd_cswitch_handler
+};
+#endif
+
+#if SCHEDULER_EDF
+static const cli_command_t edf_cmd = {
+    .name = "edf",
+    .help = "EDF tasks: period, deadline, budget, jobs, deadline misses, overruns",
+    .handler = cmd_edf_handler
+};
+#endif
+
+#if SCHEDULER_CPU_STATS
+static const cli_command_t top_cmd = {
+    .name = "top",
+    .help = "Per-task CPU usage over a sliding window",
+    .handler = cmd_top_handler
+};
+#endif
+
+#if KERNEL_TRACE
+static const cli_command_t trace_cmd = {
+    .name = "trace",
+    .help = "Event trace: trace [start|stop|clear|dump] (dump is binary, see trace2chrome.py)",
+    .handler = cmd_trace_handler
+};
+#endif
+
+#if PROFILER
+static const cli_command_t prof_cmd = {
+    .name = "prof",
+    .help = "PC-sampling profiler: prof [start [hz]|stop|clear|dump]",
+    .handler = cmd_prof_handler
+};
+#endif
+
+#if TASK_WATCHDOG
+static const cli_command_t watchdog_cmd = {
+    .name = "watchdog",
+    .help = "Watchdog slots, reset cause and last stall: watchdog [clear]",
+    .handler = cmd_watchdog_handler
+};
+#endif
+
+#if STACK_PROFILE
+static const cli_command_t stackfit_cmd = {
+    .name = "stackfit",
+    .help = "Recommended stack sizes from peaks kept across resets: stackfit [clear]",
+    .handler = cmd_stackfit_handler
+};
+#endif
+
+#if KERNEL_BENCH
+static const cli_command_t bench_cmd = {
+    .name = "bench",
+    .help = "Kernel latency benchmark: bench [iterations] (default 100)",
+    .handler = cmd_bench_handler
+};
+#endif
+
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
 static const cli_command_t heap_test_cmd = {
     .name = "heaptest",
@@ -134,8 +264,8 @@ static int cmd_task_list_handler(int argc, char **argv)
     extern task_t task_list[MAX_TASKS];
 
     cli_printf("Task List:\r\n");
-    cli_printf("ID   State      Stack Location\r\n");
-    cli_printf("---  ---------  --------------\r\n");
+    cli_printf("ID   Prio  State      Stack Location\r\n");
+    cli_printf("---  ----  ---------  --------------\r\n");
 
     /* Count active tasks */
     uint32_t count = 0;
@@ -150,15 +280,14 @@ static int cmd_task_list_handler(int argc, char **argv)
                 default:            state_str = "UNKNOWN"; break;
             }
 
-#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
-            cli_printf("%u   %s      STATIC\r\n", task_list[i].task_id, state_str);
-#else
             if (task_list[i].stack_ptr != NULL) {
-                cli_printf("%u   %s      %x\r\n", task_list[i].task_id, state_str, (unsigned int)task_list[i].stack_ptr);
+                cli_printf("%u   %u     %s      %x%s\r\n", (unsigned int)task_list[i].handle,
+                           (unsigned int)task_list[i].priority, state_str,
+                           (unsigned int)(uintptr_t)task_list[i].stack_ptr,
+                           task_list[i].stack_external ? " (static)" : "");
             } else {
                 cli_printf("Error loacting memory");
             }
-#endif
             count++;
         }
     }
@@ -168,6 +297,15 @@ static int cmd_task_list_handler(int argc, char **argv)
     return 0;
 }
 
+#if SCHEDULER_LOAD_STATS
+/* LOAD_FIXED_ONE-based value with two decimals (cli_printf has no widths) */
+static void print_load_fixed(uint32_t value) {
+    uint32_t hundredths = (uint32_t)(((uint64_t)value * 100U + LOAD_FIXED_ONE / 2U) >> LOAD_FIXED_SHIFT);
+    uint32_t frac = hundredths % 100U;
+    cli_printf("%u.%s%u", (unsigned int)(hundredths / 100U), (frac < 10U) ? "0" : "", (unsigned int)frac);
+}
+#endif
+
 static int cmd_uptime_handler(int argc, char **argv) {
     (void)argc;
     (void)argv;
@@ -192,6 +330,21 @@ static int cmd_uptime_handler(int argc, char **argv) {
     cli_printf("Uptime: %u Days, %u Hours, %u Minutes, %u Seconds.%u\r\n",
                         days,    hours,    minutes,    seconds,   mili_sec);
 
+#if SCHEDULER_LOAD_STATS
+    load_stats_t load;
+    scheduler_get_load_stats(&load);
+
+    cli_printf("Load average: ");
+    print_load_fixed(load.load_1s);
+    cli_printf(", ");
+    print_load_fixed(load.load_10s);
+    cli_printf(", ");
+    print_load_fixed(load.load_60s);
+    cli_printf(" (1s, 10s, 60s)\r\nReady queue: avg ");
+    print_load_fixed(load.ready_avg);
+    cli_printf(", max %u\r\n", (unsigned int)load.ready_max);
+#endif
+
     return 0;
 }
 
@@ -202,16 +355,17 @@ static int cmd_kill_handler(int argc, char **argv) {
         return -1;
     }
 
-    uint16_t task_id = (uint16_t)atoi(argv[1]);
-    int32_t result = task_delete(task_id);
+    /* The ID shown by 'tasks' is the task handle, resolved in O(1) */
+    task_handle_t handle = (task_handle_t)atoi(argv[1]);
+    int32_t result = task_delete(handle);
 
     /* 2. User Feedback */
     if (result == TASK_DELETE_SUCCESS) {
-        cli_printf("Task %u killed.\r\n", task_id);
+        cli_printf("Task %u killed.\r\n", (unsigned int)handle);
     } else if (result == TASK_DELETE_TASK_NOT_FOUND) {
-        cli_printf("Error: Task %u not found.\r\n", task_id);
+        cli_printf("Error: Task %u not found (or stale ID).\r\n", (unsigned int)handle);
     } else {
-        cli_printf("Error: Could not kill task %u (Code %d).\r\n", task_id, result);
+        cli_printf("Error: Could not kill task %u (Code %d).\r\n", (unsigned int)handle, result);
     }
     return 0;
 }
@@ -233,6 +387,464 @@ static int cmd_reboot_handler(int argc, char **argv) {
     return 0;
 }
 
+static int cmd_mutex_handler(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    mutex_info_t info;
+    uint32_t index = 0;
+
+    cli_printf("Name        Owner  Wait  Locks  Contended  Timeouts  Inherit  MaxWait\r\n");
+    while (mutex_get_info(index, &info) == 0) {
+        cli_printf("%s  %u  %u  %u  %u  %u  %u  %u\r\n",
+                   info.name != NULL ? info.name : "?",
+                   (unsigned int)info.owner,
+                   (unsigned int)info.waiters,
+                   (unsigned int)info.stats.locks,
+                   (unsigned int)info.stats.contentions,
+                   (unsigned int)info.stats.timeouts,
+                   (unsigned int)info.stats.inheritances,
+                   (unsigned int)info.stats.max_wait_ticks);
+        index++;
+    }
+
+    if (index == 0) {
+        cli_printf("No mutexes\r\n");
+    }
+
+    return 0;
+}
+
+
+static int cmd_queues_handler(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    queue_info_t info;
+    uint32_t index = 0;
+
+    cli_printf("Name        Item  Used/Cap  HighWater  Sent  Received  Full\r\n");
+    while (queue_get_info(index, &info) == 0) {
+        cli_printf("%s  %u  %u/%u  %u  %u  %u  %u\r\n",
+                   info.name != NULL ? info.name : "?",
+                   (unsigned int)info.item_size,
+                   (unsigned int)info.used,
+                   (unsigned int)info.capacity,
+                   (unsigned int)info.stats.high_water,
+                   (unsigned int)info.stats.sends,
+                   (unsigned int)info.stats.receives,
+                   (unsigned int)info.stats.send_fails);
+        index++;
+    }
+
+    if (index == 0) {
+        cli_printf("No queues\r\n");
+    }
+
+    return 0;
+}
+
+
+#if STACK_WATERMARK
+static int cmd_stacks_handler(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    extern task_t task_list[MAX_TASKS];
+
+    cli_printf("ID      Size   Used   Peak   Peak%%\r\n");
+    cli_printf("------  -----  -----  -----  -----\r\n");
+
+    uint32_t total_size = 0;
+    uint32_t total_peak = 0;
+
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        task_t *task = &task_list[i];
+        if (task->state == TASK_UNUSED || task->state == TASK_ZOMBIE) {
+            continue;
+        }
+
+        task_stack_info_t info;
+        if (task_get_stack_info(task->handle, &info) != 0) {
+            continue;
+        }
+
+        cli_printf("%u%s  %u   %u    %u    %u%%\r\n",
+                   (unsigned int)task->handle, task->is_idle ? " (idle)" : "",
+                   (unsigned int)info.size, (unsigned int)info.used,
+                   (unsigned int)info.peak, (unsigned int)(info.peak * 100U / info.size));
+
+        total_size += info.size;
+        total_peak += info.peak;
+    }
+
+    cli_printf("\r\nStacks: %u bytes, %u never touched\r\n",
+               (unsigned int)total_size, (unsigned int)(total_size - total_peak));
+
+#if STACK_MPU_GUARD
+    stack_fault_info_t fault;
+    scheduler_get_stack_fault(&fault);
+    if (fault.count != 0) {
+        cli_printf("Guard faults: %u, last task %u at 0x%x (MMFSR 0x%x)\r\n",
+                   (unsigned int)fault.count, (unsigned int)fault.handle,
+                   (unsigned int)fault.address, (unsigned int)fault.mmfsr);
+    }
+#endif
+
+    return 0;
+}
+#endif
+
+
+#if SCHEDULER_EDF
+static int cmd_edf_handler(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    extern task_t task_list[MAX_TASKS];
+
+    cli_printf("ID      Period  Deadln  Budget  Jobs      Misses  Overruns\r\n");
+    cli_printf("------  ------  ------  ------  --------  ------  --------\r\n");
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        edf_state_t edf;
+        if (task_list[i].state == TASK_UNUSED ||
+            task_get_edf_stats(task_list[i].handle, &edf) != 0) {
+            continue;
+        }
+
+        cli_printf("%u   %u      %u      %u      %u      %u      %u\r\n",
+                   (unsigned int)task_list[i].handle,
+                   (unsigned int)edf.params.period_ticks, (unsigned int)edf.params.deadline_ticks,
+                   (unsigned int)edf.params.budget_ticks, (unsigned int)edf.jobs,
+                   (unsigned int)edf.misses, (unsigned int)edf.overruns);
+        count++;
+    }
+
+    /* EDF_DENSITY_ONE is 1 << 16; a shift, not a 64-bit divide */
+    uint32_t density_pct10 = (uint32_t)(((uint64_t)scheduler_edf_density() * 1000U) >> 16);
+    cli_printf("\r\nEDF tasks: %u, admitted %u.%u%% of %u%%\r\n", (unsigned int)count,
+               (unsigned int)(density_pct10 / 10U), (unsigned int)(density_pct10 % 10U),
+               (unsigned int)EDF_UTILIZATION_LIMIT_PCT);
+
+    return 0;
+}
+#endif
+
+
+#if CONTEXT_SWITCH_PROFILING
+/* Keeps the FPU busy for one second so its switches use extended frames */
+static void fpu_load_task(void *arg) {
+    (void)arg;
+    volatile float acc = 1.0f;
+    uint32_t start = systick_ticks;
+
+    while ((systick_ticks - start) < 1000) {
+        acc = acc * 1.0001f + 0.5f;
+    }
+}
+
+static void print_cycle_stats(const char *name, const cycle_stats_t *stats) {
+    cli_printf("%s %u     %u     %u     %u\r\n", name,
+               (unsigned int)stats->count,
+               (unsigned int)stats->min_cycles,
+               (unsigned int)cycle_stats_avg(stats),
+               (unsigned int)stats->max_cycles);
+}
+
+static int cmd_cswitch_handler(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "fpu") == 0) {
+        if (task_create(fpu_load_task, NULL, STACK_SIZE_1KB) < 0) {
+            cli_printf("Error: could not start FPU load task\r\n");
+            return -1;
+        }
+        cli_printf("FPU load running for 1s, run 'cswitch' again afterwards.\r\n");
+        return 0;
+    }
+
+    cycle_stats_t integer;
+    cycle_stats_t fpu;
+    scheduler_get_switch_stats(&integer, &fpu);
+
+    cli_printf("Context switch cycles (PendSV entry to exit):\r\n");
+    cli_printf("Frame    Count  Min   Avg   Max\r\n");
+    print_cycle_stats("integer ", &integer);
+    print_cycle_stats("fpu     ", &fpu);
+
+    return 0;
+}
+#endif
+
+#if KERNEL_TRACE
+static int cmd_trace_handler(int argc, char **argv) {
+    if (argc < 2) {
+        uint32_t total = trace_total();
+        uint32_t held = (total < TRACE_BUFFER_RECORDS) ? total : TRACE_BUFFER_RECORDS;
+        cli_printf("Trace %s: %u of %u records, %u overwritten\r\n",
+                   trace_is_enabled() ? "recording" : "stopped", (unsigned int)held,
+                   (unsigned int)TRACE_BUFFER_RECORDS, (unsigned int)(total - held));
+        return 0;
+    }
+
+    if (strcmp(argv[1], "start") == 0) {
+        trace_set_enabled(1);
+    } else if (strcmp(argv[1], "stop") == 0) {
+        trace_set_enabled(0);
+    } else if (strcmp(argv[1], "clear") == 0) {
+        trace_clear();
+    } else if (strcmp(argv[1], "dump") == 0) {
+        extern task_t task_list[MAX_TASKS];
+
+        /* Slot legend for the decoder, then the binary block */
+        for (uint32_t i = 0; i < MAX_TASKS; i++) {
+            if (task_list[i].state != TASK_UNUSED) {
+                cli_printf("T %u %u %u%s\r\n", (unsigned int)i, (unsigned int)task_list[i].handle,
+                           (unsigned int)task_list[i].priority, task_list[i].is_idle ? " idle" : "");
+            }
+        }
+
+        int32_t count = trace_dump(cli_write);
+        if (count < 0) {
+            cli_printf("\r\nError: console has no binary output\r\n");
+            return -1;
+        }
+        cli_printf("\r\nTrace: %d records\r\n", (int)count);
+    } else {
+        cli_printf("Usage: trace [start|stop|clear|dump]\r\n");
+        return -1;
+    }
+
+    return 0;
+}
+#endif
+
+#if PROFILER
+static int cmd_prof_handler(int argc, char **argv) {
+    profiler_info_t info;
+
+    if (argc >= 2 && strcmp(argv[1], "start") == 0) {
+        uint32_t rate_hz = PROFILER_DEFAULT_HZ;
+        if (argc >= 3) {
+            int value = atoi(argv[2]);
+            rate_hz = (value > 0) ? (uint32_t)value : 0;
+        }
+        if (profiler_start(rate_hz) != 0) {
+            cli_printf("Usage: prof start [%u..%u]\r\n",
+                       (unsigned int)PROFILER_MIN_HZ, (unsigned int)PROFILER_MAX_HZ);
+            return -1;
+        }
+    } else if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        profiler_stop();
+    } else if (argc >= 2 && strcmp(argv[1], "clear") == 0) {
+        profiler_clear();
+    } else if (argc >= 2 && strcmp(argv[1], "dump") == 0) {
+        /* One line per non-empty bin, for scripts/prof_symbolize.py */
+        profiler_get_info(&info);
+        for (uint32_t i = 0; i < info.bins; i++) {
+            uint16_t count = profiler_bin_count(i);
+            if (count != 0) {
+                cli_printf("P %x %u\r\n", (unsigned int)(info.base + i * info.bin_bytes),
+                           (unsigned int)count);
+            }
+        }
+    } else if (argc >= 2) {
+        cli_printf("Usage: prof [start [hz]|stop|clear|dump]\r\n");
+        return -1;
+    }
+
+    profiler_get_info(&info);
+    cli_printf("Profiler %s at %u Hz: %u samples, %u outside .text, %u saturated bins\r\n",
+               info.running ? "running" : "stopped", (unsigned int)info.rate_hz,
+               (unsigned int)info.samples, (unsigned int)info.outside, (unsigned int)info.saturated);
+    cli_printf("%u bins of %u bytes from %x\r\n", (unsigned int)info.bins,
+               (unsigned int)info.bin_bytes, (unsigned int)info.base);
+
+    return 0;
+}
+#endif
+
+#if TASK_WATCHDOG
+static int cmd_watchdog_handler(int argc, char **argv) {
+    if (argc >= 2) {
+        if (strcmp(argv[1], "clear") != 0) {
+            cli_printf("Usage: watchdog [clear]\r\n");
+            return -1;
+        }
+        watchdog_clear_record();
+    }
+
+    cli_printf("Last reset: %s\r\n", watchdog_reset_by_iwdg() ? "watchdog (IWDG)" : "other");
+    cli_printf("Name        Handle  Timeout  Since  MaxGap\r\n");
+    cli_printf("----------  ------  -------  -----  ------\r\n");
+
+    for (uint32_t i = 0; i < WATCHDOG_MAX_TASKS; i++) {
+        watchdog_slot_info_t slot;
+        if (watchdog_get_slot(i, &slot) != 0) {
+            continue;
+        }
+        cli_printf("%s  %u  %u  %u  %u\r\n", slot.name, (unsigned int)slot.handle,
+                   (unsigned int)slot.timeout_ticks, (unsigned int)slot.since_checkin,
+                   (unsigned int)slot.max_gap);
+    }
+
+    const watchdog_record_t *stall = watchdog_last_stall();
+    if (stall == NULL) {
+        cli_printf("No stall recorded\r\n");
+    } else {
+        cli_printf("Last stall: '%s' (handle %u) silent %u ticks, limit %u, at uptime %u ticks\r\n",
+                   stall->name, (unsigned int)stall->handle, (unsigned int)stall->silent_ticks,
+                   (unsigned int)stall->timeout_ticks, (unsigned int)stall->uptime_ticks);
+        cli_printf("Stalls since the record was cleared: %u\r\n", (unsigned int)stall->stalls);
+    }
+
+    return 0;
+}
+#endif
+
+#if STACK_PROFILE
+static int cmd_stackfit_handler(int argc, char **argv) {
+    if (argc >= 2) {
+        if (strcmp(argv[1], "clear") != 0) {
+            cli_printf("Usage: stackfit [clear]\r\n");
+            return -1;
+        }
+        stack_profile_clear();
+    }
+
+    /* Include what happened since the last periodic pass */
+    stack_profile_sample();
+
+    cli_printf("Entry       Size   Peak   Rec    Change  Runs\r\n");
+    cli_printf("----------  -----  -----  -----  ------  ----\r\n");
+
+    uint32_t reclaim = 0;
+    uint32_t extra = 0;
+    uint32_t grow = 0;
+
+    for (uint32_t i = 0; i < STACK_PROFILE_ENTRIES; i++) {
+        stack_profile_entry_t entry;
+        if (stack_profile_get(i, &entry) != 0) {
+            continue;
+        }
+
+        uint32_t rec = stack_profile_recommend(entry.peak);
+        /* Only the canary word left: the real peak may be deeper than recorded */
+        uint8_t full = (entry.peak + sizeof(uint32_t) >= entry.size);
+
+        cli_printf("%x  %u   %u    %u    %d    %u%s\r\n", (unsigned int)entry.entry,
+                   (unsigned int)entry.size, (unsigned int)entry.peak, (unsigned int)rec,
+                   (int)rec - (int)entry.size, (unsigned int)entry.runs,
+                   full ? "  FULL" : "");
+
+        if (rec < entry.size) {
+            reclaim += entry.size - rec;
+        } else if (rec > entry.size) {
+            extra += rec - entry.size;
+            grow++;
+        }
+    }
+
+    cli_printf("\r\nMargin %u%%, %u run(s) of this build\r\n",
+               (unsigned int)STACK_PROFILE_MARGIN_PCT, (unsigned int)stack_profile_runs());
+    cli_printf("Reclaimable: %u bytes; %u task(s) should grow by %u bytes\r\n",
+               (unsigned int)reclaim, (unsigned int)grow, (unsigned int)extra);
+    if (stack_profile_dropped() != 0) {
+        cli_printf("Table full: %u call site(s) not tracked (STACK_PROFILE_ENTRIES)\r\n",
+                   (unsigned int)stack_profile_dropped());
+    }
+    cli_printf("Look up entry addresses in the map file; sizes are what to pass to task_create()\r\n");
+
+    return 0;
+}
+#endif
+
+#if KERNEL_BENCH
+#define BENCH_DEFAULT_ITERATIONS 100U
+#define BENCH_MAX_ITERATIONS     10000U
+
+static int cmd_bench_handler(int argc, char **argv) {
+    uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+
+    if (argc >= 2) {
+        int value = atoi(argv[1]);
+        if (value <= 0 || (uint32_t)value > BENCH_MAX_ITERATIONS) {
+            cli_printf("Usage: bench [1..%u]\r\n", (unsigned int)BENCH_MAX_ITERATIONS);
+            return -1;
+        }
+        iterations = (uint32_t)value;
+    }
+
+    cli_printf("Running %u iterations...\r\n", (unsigned int)iterations);
+    if (bench_run(iterations) != 0) {
+        cli_printf("Error: could not start benchmark task\r\n");
+        return -1;
+    }
+
+    cli_printf("Latency in cycles (%u MHz):\r\n", (unsigned int)(SYSCLK_HZ / 1000000UL));
+    cli_printf("Measurement         Count  Min   Avg   Max\r\n");
+    for (uint32_t id = 0; id < BENCH_COUNT; ++id) {
+        cycle_stats_t stats;
+        bench_get_stats((bench_id_t)id, &stats);
+        print_cycle_stats(bench_name((bench_id_t)id), &stats);
+    }
+
+    return 0;
+}
+#endif
+
+#if SCHEDULER_CPU_STATS
+/* part / whole in tenths of a percent, without overflowing 32 bits */
+static uint32_t cycles_permille(uint32_t part, uint32_t whole) {
+    uint32_t per_mille_unit = whole / 1000;
+    if (per_mille_unit == 0) {
+        return 0;
+    }
+    uint32_t permille = part / per_mille_unit;
+    return (permille > 1000) ? 1000 : permille;
+}
+
+static int cmd_top_handler(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    extern task_t task_list[MAX_TASKS];
+    const uint32_t cycles_per_us = SYSCLK_HZ / 1000000UL;
+
+    cpu_window_stats_t window;
+    scheduler_get_cpu_window(&window);
+
+    if (window.window_cycles == 0) {
+        cli_printf("No complete window yet, try again in a second.\r\n");
+        return 0;
+    }
+
+    uint32_t idle = cycles_permille(window.idle_cycles, window.window_cycles);
+    cli_printf("CPU: %u.%u%% busy, %u.%u%% idle (window %u ms)\r\n",
+               (unsigned int)((1000 - idle) / 10), (unsigned int)((1000 - idle) % 10),
+               (unsigned int)(idle / 10), (unsigned int)(idle % 10),
+               (unsigned int)(window.window_cycles / (SYSCLK_HZ / 1000UL)));
+    cli_printf("ID      CPU%%    Switches  MaxRun(us)\r\n");
+    cli_printf("------  ------  --------  ----------\r\n");
+
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        task_t *task = &task_list[i];
+        if (task->state == TASK_UNUSED || task->state == TASK_ZOMBIE) {
+            continue;
+        }
+
+        uint32_t cpu = cycles_permille(task->run_cycles_last, window.window_cycles);
+        cli_printf("%u%s  %u.%u%%   %u        %u\r\n",
+                   (unsigned int)task->handle, task->is_idle ? " (idle)" : "",
+                   (unsigned int)(cpu / 10), (unsigned int)(cpu % 10),
+                   (unsigned int)task->switch_count,
+                   (unsigned int)(task->max_run_cycles / cycles_per_us));
+    }
+
+    return 0;
+}
+#endif
+
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
 static int cmd_heap_test_handler(int argc, char **argv) {
     if (argc < 2) {
@@ -436,6 +1048,35 @@ void app_commands_register_all(void)
     cli_register_command(&uptime_cmd);
     cli_register_command(&kill_cmd);
     cli_register_command(&reboot_cmd);
+    cli_register_command(&mutex_cmd);
+    cli_register_command(&queues_cmd);
+#if STACK_WATERMARK
+    cli_register_command(&stacks_cmd);
+#endif
+#if CONTEXT_SWITCH_PROFILING
+    cli_register_command(&cswitch_cmd);
+#endif
+#if SCHEDULER_EDF
+    cli_register_command(&edf_cmd);
+#endif
+#if SCHEDULER_CPU_STATS
+    cli_register_command(&top_cmd);
+#endif
+#if KERNEL_TRACE
+    cli_register_command(&trace_cmd);
+#endif
+#if PROFILER
+    cli_register_command(&prof_cmd);
+#endif
+#if TASK_WATCHDOG
+    cli_register_command(&watchdog_cmd);
+#endif
+#if STACK_PROFILE
+    cli_register_command(&stackfit_cmd);
+#endif
+#if KERNEL_BENCH
+    cli_register_command(&bench_cmd);
+#endif
 
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
     cli_register_command(&heap_test_cmd);
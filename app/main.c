@@ -11,6 +11,13 @@
 #include "project_config.h"
 #include "app_commands.h"
 #include "utils.h"
+#include "dwt.h"
+#include "mutex.h"
+#include "soft_timer.h"
+#include "workqueue.h"
+#include "coroutine.h"
+#include "watchdog.h"
+#include "stack_profile.h"
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
 #include "stm32_alloc.h"
 /* Linker script symbols for heap */
@@ -21,6 +28,28 @@ extern uint32_t __heap_limit__;   /* End of SRAM1 (end of heap) */
 
 /* ---------- UART2 CLI Wrappers ---------- */
 
+/* Serializes writers (CLI, button logger) so lines are not interleaved */
+static mutex_t uart2_tx_mutex;
+
+/* CLI task, notified directly by the RX interrupt */
+static task_handle_t cli_task_handle = TASK_HANDLE_INVALID;
+
+/* The console must come up even with the heap exhausted: its stack is placed by the linker */
+static TASK_STACK_SRAM2 TASK_STACK_DEFINE(cli_stack, STACK_SIZE_2KB);
+
+/* RX callback (ISR context): wake the CLI */
+static void uart2_rx_notify(char c)
+{
+    (void)c;
+    task_notify(cli_task_handle, 0, NOTIFY_INCREMENT); /* Invalid before the CLI task exists: ignored */
+}
+
+/* CLI input wait: sleep until the next byte arrives */
+static void uart2_wait_rx(void)
+{
+    task_notify_wait(0xFFFFFFFFu, NULL, WAIT_FOREVER); /* The CLI drains the buffer, so reset the count */
+}
+
 /* Non-blocking getc for CLI */
 static int uart2_getc(char *out_ch)
 {
@@ -42,42 +71,92 @@ static int uart2_puts(const char *s)
         len++;
     }
     
-    return uart_write_buffer(USART2, s, len);
-}
+    mutex_lock(&uart2_tx_mutex);
+    int written = (int)uart_write_buffer(USART2, s, len);
+    mutex_unlock(&uart2_tx_mutex);
 
-/* ---------- Tasks ---------- */
+    return written;
+}
 
-static void task_blink(void *arg)
+/* Blocking binary write for dumps: waits for TX buffer space instead of dropping */
+static int uart2_write(const void *data, uint32_t len)
 {
-    (void)arg;
-    led_init();
+    const char *src = (const char *)data;
+    uint32_t sent = 0;
 
-    while (1) {
-        led_toggle();
-        /* Sleep cooperatively for 500 SysTick ticks (e.g., 500 ms if 1 kHz) */
-        task_sleep_ticks(500);
+    mutex_lock(&uart2_tx_mutex);
+    while (sent < len) {
+        uint32_t n = uart_write_buffer(USART2, src + sent, len - sent);
+        sent += n;
+        if (n == 0) {
+            task_sleep_ticks(1);
+        }
     }
+    mutex_unlock(&uart2_tx_mutex);
+
+    return (int)sent;
 }
 
-static void task_button_logger(void *arg)
+/* ---------- Tasks ---------- */
+
+static soft_timer_t blink_timer;
+
+#if TASK_WATCHDOG
+/* Check-in slots: the blink timer vouches for the timer daemon */
+static int32_t blink_wdt = -1;
+#endif
+
+/* Periodic timer callback, runs on the timer daemon's stack */
+static void blink_timer_cb(void *arg)
 {
     (void)arg;
+    led_toggle();
+#if TASK_WATCHDOG
+    watchdog_checkin(blink_wdt);
+#endif
+}
+
+/* Coroutines sharing one task; small state machines need no stack of their own */
+static coroutine_sched_t app_coroutines;
+
+typedef struct {
+    coroutine_t co;
+    uint32_t    prev_btn;   /* Locals do not survive a CO_SLEEP, so state lives here */
+    int32_t     wdt;        /* Watchdog slot, covers the coroutine runner task */
+} button_logger_t;
+
+static button_logger_t button_logger;
+
+static int8_t button_logger_co(coroutine_t *co, void *arg)
+{
+    button_logger_t *self = (button_logger_t *)arg;
+
+    CO_BEGIN(co);
     button_init();
+    self->prev_btn = 0;
+#if TASK_WATCHDOG
+    /* Generous: the CLI runs above this task and a long command may starve it for a while */
+    self->wdt = watchdog_register("button", 2000);
+#endif
 
-    uint32_t prev_btn = 0;
     while (1) {
         uint32_t btn = button_read();
+#if TASK_WATCHDOG
+        watchdog_checkin(self->wdt);
+#endif
 
-        if (btn && !prev_btn) {
+        if (btn && !self->prev_btn) {
             cli_printf("Button pressed\r\n");
-        } else if (!btn && prev_btn) {
+        } else if (!btn && self->prev_btn) {
             cli_printf("Button released\r\n");
         }
 
-        prev_btn = btn;
+        self->prev_btn = btn;
         /* Poll button at 50 Hz without busy-waiting */
-        task_sleep_ticks(20);
+        CO_SLEEP(co, 20);
     }
+
+    CO_END(co);
 }
 
 /* ---------- main ---------- */
@@ -100,10 +179,13 @@ int main(void)
     uint32_t pclk1_hz = get_system_clock_hz();
     uart_init(USART2, &uart_config, pclk1_hz);
 
-    /* Enable UART2 interrupts in NVIC */
-    NVIC_ISER1 |= (1UL << (USART2_IRQn & 0x1F));
+    /* Enable UART2 interrupts in NVIC, below MAX_SYSCALL_PRIORITY so kernel
+     * critical sections (BASEPRI) also keep the RX/TX ISR out */
+    nvic_set_priority(USART2_IRQn, UART_IRQ_PRIORITY);
+    nvic_enable_irq(USART2_IRQn);
     
-    /* Enable RX interrupt for buffered reception */
+    /* Enable RX interrupt for buffered reception, signalling the CLI per byte */
+    uart_set_rx_callback(USART2, uart2_rx_notify);
     uart_enable_rx_interrupt(USART2, 1);
     
     /* Enable TX interrupt for buffered transmission */
@@ -117,23 +199,64 @@ int main(void)
     stm32_allocator_init(heap_start_addr, heap_size);
 #endif
     
+    /* Start the cycle counter used for context switch profiling */
+    dwt_init();
+
     /* Initialize scheduler and SysTick (1 kHz tick) */
     scheduler_init();
     systick_init(1000);
+
+#if TASK_WATCHDOG
+    /* Before anything registers: picks up a stall record from the last run */
+    watchdog_init();
+#endif
     
     /* Initialize CLI */
+    mutex_init(&uart2_tx_mutex, "uart2_tx");
     cli_init("OS> ", uart2_getc, uart2_puts);
+    cli_set_input_wait(uart2_wait_rx);
+    cli_set_binary_output(uart2_write);
     
     /* Register application commands */
     app_commands_register_all();
     
-    /* Create application tasks */
-    task_create(task_blink, NULL, STACK_SIZE_1KB);
-    task_create(task_button_logger, NULL, STACK_SIZE_1KB);
+    /* Timer daemon; periodic jobs become timers instead of tasks with their own stack */
+    soft_timer_service_init();
+
+    /* Worker for bottom halves deferred from interrupt handlers */
+    workqueue_system_init();
+
+#if STACK_PROFILE
+    /* Stack peaks of earlier runs of this build, sampled once a second from here on */
+    stack_profile_init();
+#endif
+
+    /* Blink the LED every 500 ticks (500 ms at 1 kHz) */
+    led_init();
+    soft_timer_init(&blink_timer, "blink", blink_timer_cb, NULL, 500, SOFT_TIMER_PERIODIC);
+    soft_timer_start(&blink_timer);
+#if TASK_WATCHDOG
+    /* Claimed before the scheduler runs, so owned by no task: a dead timer daemon still trips it */
+    blink_wdt = watchdog_register("timers", 1500);
+#endif
+
+    /* Create application tasks; the button logger runs as a coroutine */
+    coroutine_sched_init(&app_coroutines);
+    coroutine_start(&app_coroutines, &button_logger.co, button_logger_co, &button_logger);
+    coroutine_sched_start(&app_coroutines, TASK_PRIORITY_DEFAULT, STACK_SIZE_1KB);
     
-    /* Create CLI task */
-    task_create(cli_task_entry, NULL, STACK_SIZE_2KB);
+    /* Create CLI task, one level up so a keypress preempts the other tasks */
+    int32_t cli_handle = task_create_static(cli_task_entry, NULL, cli_stack, sizeof(cli_stack));
+    if (cli_handle >= 0) {
+        cli_task_handle = (task_handle_t)cli_handle;
+        task_set_priority(cli_task_handle, TASK_PRIORITY_DEFAULT + 1);
+    }
     
+#if TASK_WATCHDOG
+    /* From here on a stalled check-in slot ends in an IWDG reset */
+    watchdog_start();
+#endif
+
     /* Start the scheduler - does not return */
     scheduler_start();
     
@@ -1,7 +1,10 @@
 #ifndef PROJECT_CONFIG_H
 #define PROJECT_CONFIG_H
 
+/* This header is also included by context_switch.S */
+#ifndef __ASSEMBLER__
 #include <stdint.h>
+#endif
 
 /* ============================================================================
    System Clock Configuration
@@ -15,11 +18,11 @@
    
    STATIC MODE (TASK_ALLOC_STATIC):
    ---------------------------------
-   - Task stacks are embedded in the task_t structure
+   - task_create() takes a stack from a pool of TASK_STATIC_STACKS stacks
    - All stacks allocated at compile time in .bss section
-   - Memory usage: ~60 KB for task_list[58] (1032 bytes per task)
+   - Memory usage: ~58 KB for 58 pooled stacks (1024 bytes each)
    - Pros: Simple, predictable, no allocation failures
-   - Cons: Wastes memory if not all tasks used, large .bss section
+   - Cons: Wastes memory if not all stacks used, large .bss section
    - Best for: Systems with fixed number of tasks, plenty of RAM
    
    DYNAMIC MODE (TASK_ALLOC_DYNAMIC):
@@ -86,8 +89,157 @@
 /* Stack overflow detection */
 #define STACK_CANARY           0xDEADBEEF  /* Magic value at stack bottom */
 
-/* Garbage collection */
-#define GARBAGE_COLLECTION_TICKS 1000U  /* Run GC every 1000 ticks (1 second at 1kHz) */
+/* Stack high-water marks
+ * task_create() paints each stack with STACK_PAINT_PATTERN; the 'stacks' command
+ * scans up from the bottom for the first overwritten word to find peak usage.
+ * Costs one store per stack word at creation time.
+ */
+#define STACK_WATERMARK        1
+#define STACK_PAINT_PATTERN    0xA5A5A5A5u
+
+/* Stack right-sizing ('stackfit' command)
+ * A timer-daemon job records each task's peak in a .noinit table that keeps
+ * the worst case across resets of the same build; 'stackfit' recommends
+ * peak + STACK_PROFILE_MARGIN_PCT per task and totals the RAM that frees.
+ */
+#define STACK_PROFILE              1
+#define STACK_PROFILE_ENTRIES      24     /* Distinct task_create() call sites tracked */
+#define STACK_PROFILE_SAMPLE_TICKS 1000   /* Scan all stacks once a second */
+#define STACK_PROFILE_MARGIN_PCT   25     /* Headroom added to the observed peak */
+
+/* MPU stack guard
+ * A no-access MPU region sits at the bottom of every stack and is moved to the
+ * incoming task on each switch (one RBAR write). An overflow faults on the first
+ * store into it and MemManage kills the offending task. The guard base must be
+ * aligned to its size, so dynamic stacks are allocated 2 * STACK_GUARD_SIZE
+ * larger; static stacks give up to that much of STACK_SIZE_BYTES.
+ * With the FPU an exception frame is 104 bytes, and PendSV pushes 36 more
+ * (plus 64 for S16-S31) below it, so one push can step over a small guard.
+ */
+#define STACK_MPU_GUARD        1
+#if defined(__ARM_FP)
+#define STACK_GUARD_SIZE_LOG2  7      /* 128 bytes, deeper than any single FPU push */
+#else
+#define STACK_GUARD_SIZE_LOG2  5      /* 32 bytes, the smallest MPU region */
+#endif
+#define STACK_GUARD_SIZE       (1u << STACK_GUARD_SIZE_LOG2)
+
+/* Task priorities: higher number runs first, equal priorities share the CPU
+ * round-robin on every tick. Level 0 is reserved for the idle task. */
+#define TASK_PRIORITY_LEVELS     8
+#define TASK_PRIORITY_DEFAULT    2      /* Priority given by task_create() */
+
+/* Context switch profiling
+ * PendSV stamps entry/exit with DWT->CYCCNT and the scheduler keeps min/avg/max
+ * separately for switches that moved FPU state (S16-S31) and those that did not.
+ * Costs ~10 cycles per switch. Set to 0 to remove it from PendSV entirely.
+ */
+#define CONTEXT_SWITCH_PROFILING 1
+
+/* Per-task CPU accounting
+ * Every switch charges the DWT cycles since the previous switch to the outgoing
+ * task. The 'top' command reports % CPU over the last CPU_STATS_WINDOW_TICKS,
+ * a window that slides every CPU_STATS_WINDOW_TICKS / CPU_STATS_WINDOW_SLICES.
+ * The wake scan in SysTick moves it, so PendSV only adds up cycles. Costs
+ * 4 * CPU_STATS_WINDOW_SLICES bytes per task slot.
+ */
+#define SCHEDULER_CPU_STATS      1
+#define CPU_STATS_WINDOW_TICKS   1000U  /* 1 second at 1kHz */
+#define CPU_STATS_WINDOW_SLICES  4U     /* Slides every 250 ms */
+
+/* Load averages ('uptime')
+ * The wake scan counts runnable tasks on every tick. Each LOAD_SAMPLE_TICKS
+ * period's mean feeds exponentially decayed 1 s, 10 s and 60 s averages
+ * (as in Unix load averages, but over 100 ms samples), and the tick also
+ * tracks the mean and peak number of ready tasks waiting for the CPU.
+ */
+#define SCHEDULER_LOAD_STATS     1
+#define LOAD_SAMPLE_TICKS        100U   /* 100 ms at 1kHz; the decay factors assume this */
+
+/* Earliest-deadline-first class
+ * Periodic tasks created with task_create_edf() share one priority level and,
+ * within it, the one with the earliest absolute deadline runs first. Fixed-
+ * priority tasks above EDF_TASK_PRIORITY still preempt them. Admission keeps
+ * the sum of budget / min(deadline, period) under EDF_UTILIZATION_LIMIT_PCT;
+ * SysTick charges budgets and counts deadline misses.
+ */
+#define SCHEDULER_EDF            1
+#define EDF_TASK_PRIORITY        (TASK_PRIORITY_DEFAULT + 2)  /* Above app tasks and the CLI */
+#define EDF_UTILIZATION_LIMIT_PCT 90    /* Leave 10% for the fixed-priority tasks below */
+
+/* Kernel latency benchmarks ('bench' command)
+ * Compiles cycle probes into schedule_next_task, scheduler_wake_sleeping_tasks and
+ * PendSV (via CONTEXT_SWITCH_PROFILING). The probes only record while a 'bench'
+ * run is in progress, so leaving this on costs two CYCCNT reads per call.
+ */
+#define KERNEL_BENCH             1
+#define BENCH_SWI_PRIORITY       6      /* Software IRQ used for ISR-to-task latency */
+
+/* Software timers
+ * Active timers sit in expiry-sorted lists that SysTick checks at the head only.
+ * Callbacks run in a single daemon task, or straight from SysTick for timers
+ * created with SOFT_TIMER_ISR_CONTEXT.
+ */
+#define SOFT_TIMER_TASK_PRIORITY (TASK_PRIORITY_LEVELS - 2)  /* Above normal tasks, below the top level */
+#define SOFT_TIMER_TASK_STACK    STACK_SIZE_1KB
+
+/* System work queue (deferred interrupt work)
+ * ISRs submit function + argument pairs lock-free; worker tasks run them.
+ * Workers sit at the top priority so deferred work runs right after the ISR
+ * unless something more urgent is ready.
+ */
+#define WORKQUEUE_SYSTEM_DEPTH     32     /* Slots, power of two */
+#define WORKQUEUE_SYSTEM_WORKERS   1
+#define WORKQUEUE_SYSTEM_PRIORITY  TASK_PRIORITY_MAX
+#define WORKQUEUE_SYSTEM_STACK     STACK_SIZE_1KB
+
+/* Stackless coroutines
+ * Coroutines share one runner task and its stack. The runner wakes for the
+ * earliest CO_SLEEP deadline, or after this many ticks to re-poll CO_AWAIT
+ * conditions nobody signalled with coroutine_sched_wake().
+ */
+#define COROUTINE_POLL_TICKS       10
+
+/* Run-to-completion (SST) tasks
+ * Each level is an otherwise unused interrupt line (SAI1, SAI2, SWPMI1, TSC)
+ * pended from software; handlers run on the shared MSP. Level 1 gets
+ * SST_NVIC_PRIORITY_LOWEST, each level above it one NVIC step more urgent.
+ * All levels preempt every blocking task and must stay kernel-callable.
+ */
+#define SST_PRIORITY_LEVELS        4      /* At most 4: one IRQ line per level */
+#define SST_NVIC_PRIORITY_LOWEST   13     /* Below the UART, above SysTick */
+
+/* Kernel event trace ('trace' command)
+ * Context switches, sleeps, wakes, blocks, instrumented ISRs and heap calls
+ * go into a ring of 8-byte DWT-stamped records, overwritten oldest first.
+ * 'trace dump' streams it as binary for scripts/trace2chrome.py.
+ * Costs about 20 cycles per event. Set to 0 to compile the hooks out.
+ */
+#define KERNEL_TRACE               1
+#define TRACE_BUFFER_RECORDS       512    /* Power of two; 4KB at 8 bytes each */
+
+/* PC-sampling profiler ('prof' command)
+ * TIM7 samples the interrupted PC into PROFILER_BINS 16-bit counters spread
+ * over .text; scripts/prof_symbolize.py names the hot functions from the map
+ * file. The sampler sits above MAX_SYSCALL_PRIORITY so kernel critical
+ * sections show up in the profile; it never calls the kernel.
+ */
+#define PROFILER                   1
+#define PROFILER_BINS              1024   /* 2KB of counters */
+#define PROFILER_DEFAULT_HZ        997    /* Prime, so sampling does not lock onto the 1 kHz tick */
+#define PROFILER_MIN_HZ            16     /* TIM7 at 1 MHz with a 16-bit reload */
+#define PROFILER_MAX_HZ            20000
+#define PROFILER_IRQ_PRIORITY      4
+
+/* Task watchdog ('watchdog' command)
+ * Registered check-in slots must report within their deadline. A SysTick
+ * supervisor kicks the IWDG only while all of them do; a missed deadline is
+ * recorded in .noinit RAM and the IWDG resets the MCU.
+ */
+#define TASK_WATCHDOG              1
+#define WATCHDOG_MAX_TASKS         8
+#define WATCHDOG_CHECK_TICKS       100    /* Supervisor period */
+#define WATCHDOG_IWDG_TIMEOUT_MS   2000   /* Hardware timeout after the last kick */
 
 /* ============================================================================
    Interrupt Priorities (ARM Cortex-M)
@@ -104,6 +256,11 @@
 #define MAX_SYSCALL_PRIORITY   5   /* Highest priority that can call RTOS functions */
 #define SYSTICK_PRIORITY       14  /* SysTick priority (lower than peripherals) */
 #define PENDSV_PRIORITY        15  /* PendSV priority (lowest for context switch) */
+#define UART_IRQ_PRIORITY      6   /* USART2: calls kernel functions, so >= MAX_SYSCALL_PRIORITY */
+
+/* BASEPRI value for kernel critical sections. Priority registers only implement
+ * the top 4 bits, so the level has to be shifted into place (5 -> 0x50). */
+#define MAX_SYSCALL_BASEPRI    (MAX_SYSCALL_PRIORITY << 4)
 
 /* ============================================================================
    Stack Size Configuration
@@ -111,6 +268,11 @@
 #define STACK_SIZE_IN_WORDS      255    /* Default: 255 words = 1020 bytes */
 #define STACK_SIZE_BYTES         (STACK_SIZE_IN_WORDS * sizeof(uint32_t))
 
+/* Static mode: stacks in the task_create() pool, idle task included. Tasks
+ * made with task_create_static() bring their own and take none, so this can
+ * be lowered to what task_create() callers need. */
+#define TASK_STATIC_STACKS       MAX_TASKS
+
 /* Dynamic allocation limits */
 #define STACK_MIN_SIZE_BYTES     512    /* Minimum stack size (128 words) */
 #define STACK_MAX_SIZE_BYTES     8192   /* Maximum stack size (2048 words) */
@@ -152,13 +314,118 @@
     #warning "Stack size very large - may waste memory"
 #endif
 
+#if (TASK_PRIORITY_LEVELS < 2) || (TASK_PRIORITY_LEVELS > 32)
+    #error "TASK_PRIORITY_LEVELS must be between 2 and 32 (one ready-bitmap word)"
+#endif
+
+#if (TASK_PRIORITY_DEFAULT < 1) || (TASK_PRIORITY_DEFAULT >= TASK_PRIORITY_LEVELS)
+    #error "TASK_PRIORITY_DEFAULT must be between 1 and TASK_PRIORITY_LEVELS - 1"
+#endif
+
+#if (SOFT_TIMER_TASK_PRIORITY < 1) || (SOFT_TIMER_TASK_PRIORITY >= TASK_PRIORITY_LEVELS)
+    #error "SOFT_TIMER_TASK_PRIORITY must be between 1 and TASK_PRIORITY_LEVELS - 1"
+#endif
+
+#if SCHEDULER_EDF && ((EDF_TASK_PRIORITY < 1) || (EDF_TASK_PRIORITY >= TASK_PRIORITY_LEVELS))
+    #error "EDF_TASK_PRIORITY must be between 1 and TASK_PRIORITY_LEVELS - 1"
+#endif
+
+#if SCHEDULER_EDF && ((EDF_UTILIZATION_LIMIT_PCT < 1) || (EDF_UTILIZATION_LIMIT_PCT > 100))
+    #error "EDF_UTILIZATION_LIMIT_PCT must be between 1 and 100"
+#endif
+
+#if STACK_MPU_GUARD && (STACK_GUARD_SIZE_LOG2 < 5)
+    #error "STACK_GUARD_SIZE_LOG2 must be at least 5 (32-byte MPU regions)"
+#endif
+
+#if STACK_MPU_GUARD && defined(__ARM_FP) && (STACK_GUARD_SIZE_LOG2 < 7)
+    #error "STACK_GUARD_SIZE_LOG2 must be at least 7 with the FPU (a 104-byte frame can jump a smaller guard)"
+#endif
+
+#if (WORKQUEUE_SYSTEM_DEPTH < 2) || (WORKQUEUE_SYSTEM_DEPTH & (WORKQUEUE_SYSTEM_DEPTH - 1))
+    #error "WORKQUEUE_SYSTEM_DEPTH must be a power of two >= 2"
+#endif
+
+#if COROUTINE_POLL_TICKS < 1
+    #error "COROUTINE_POLL_TICKS must be at least 1"
+#endif
+
+#if SCHEDULER_CPU_STATS && ((CPU_STATS_WINDOW_SLICES < 1) || (CPU_STATS_WINDOW_SLICES > 16) || \
+                            (CPU_STATS_WINDOW_TICKS % CPU_STATS_WINDOW_SLICES) != 0)
+    #error "CPU_STATS_WINDOW_SLICES must be 1..16 and divide CPU_STATS_WINDOW_TICKS"
+#endif
+
+#if SCHEDULER_LOAD_STATS && ((LOAD_SAMPLE_TICKS < 1) || ((MAX_TASKS * LOAD_SAMPLE_TICKS) >= 65536))
+    #error "LOAD_SAMPLE_TICKS out of range (the period sum is shifted into 16.16 fixed point)"
+#endif
+
+#if KERNEL_TRACE && ((TRACE_BUFFER_RECORDS < 2) || (TRACE_BUFFER_RECORDS & (TRACE_BUFFER_RECORDS - 1)))
+    #error "TRACE_BUFFER_RECORDS must be a power of two >= 2"
+#endif
+
+#if PROFILER && ((PROFILER_IRQ_PRIORITY < 0) || (PROFILER_IRQ_PRIORITY > 15))
+    #error "PROFILER_IRQ_PRIORITY must be between 0 and 15"
+#endif
+
+#if PROFILER && ((PROFILER_DEFAULT_HZ < PROFILER_MIN_HZ) || (PROFILER_DEFAULT_HZ > PROFILER_MAX_HZ))
+    #error "PROFILER_DEFAULT_HZ must be between PROFILER_MIN_HZ and PROFILER_MAX_HZ"
+#endif
+
+#if TASK_WATCHDOG && ((WATCHDOG_IWDG_TIMEOUT_MS < 1) || (WATCHDOG_IWDG_TIMEOUT_MS > 32000))
+    #error "WATCHDOG_IWDG_TIMEOUT_MS must be between 1 and 32000"
+#endif
+
+#if TASK_WATCHDOG && (WATCHDOG_IWDG_TIMEOUT_MS <= 2 * WATCHDOG_CHECK_TICKS)
+    #error "WATCHDOG_IWDG_TIMEOUT_MS must leave room for more than two supervisor periods (1 tick = 1 ms)"
+#endif
+
+#if STACK_PROFILE && !STACK_WATERMARK
+    #error "STACK_PROFILE needs STACK_WATERMARK (peaks come from the paint scan)"
+#endif
+
+#if STACK_PROFILE && ((STACK_PROFILE_ENTRIES < 1) || (STACK_PROFILE_ENTRIES > 255))
+    #error "STACK_PROFILE_ENTRIES must be between 1 and 255"
+#endif
+
+#if STACK_PROFILE && (STACK_PROFILE_MARGIN_PCT > 200)
+    #error "STACK_PROFILE_MARGIN_PCT must be between 0 and 200"
+#endif
+
+#if (SST_PRIORITY_LEVELS < 1) || (SST_PRIORITY_LEVELS > 4)
+    #error "SST_PRIORITY_LEVELS must be between 1 and 4"
+#endif
+
+#if (SST_NVIC_PRIORITY_LOWEST - SST_PRIORITY_LEVELS + 1) < MAX_SYSCALL_PRIORITY
+    #error "SST levels must not be above MAX_SYSCALL_PRIORITY (handlers call the kernel)"
+#endif
+
+#if SST_NVIC_PRIORITY_LOWEST >= PENDSV_PRIORITY
+    #error "SST levels must preempt PendSV"
+#endif
+
+#if UART_IRQ_PRIORITY < MAX_SYSCALL_PRIORITY
+    #error "UART_IRQ_PRIORITY must not be above MAX_SYSCALL_PRIORITY"
+#endif
+
+#if KERNEL_BENCH && !CONTEXT_SWITCH_PROFILING
+    #error "KERNEL_BENCH needs CONTEXT_SWITCH_PROFILING for the PendSV measurements"
+#endif
+
+#if KERNEL_BENCH && (BENCH_SWI_PRIORITY < MAX_SYSCALL_PRIORITY)
+    #error "BENCH_SWI_PRIORITY must not be above MAX_SYSCALL_PRIORITY (it calls task_unblock)"
+#endif
+
 /* Verify MAX_TASKS is reasonable */
 #if MAX_TASKS < 2
     #error "MAX_TASKS must be at least 2 (for idle + 1 user task)"
 #endif
 
-#if (TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC) && (MAX_TASKS > 58)
-    #warning "With static allocation, many tasks will consume a lot of .bss memory"
+#if (TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC) && ((TASK_STATIC_STACKS < 1) || (TASK_STATIC_STACKS > MAX_TASKS))
+    #error "TASK_STATIC_STACKS must be 1..MAX_TASKS (the idle task takes one)"
+#endif
+
+#if (TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC) && (TASK_STATIC_STACKS > 58)
+    #warning "With static allocation, many stacks will consume a lot of .bss memory"
 #endif
 
 #if (TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC) && (MAX_TASKS * STACK_SIZE_IN_WORDS * 4 > 90000)
@@ -1,4 +1,5 @@
 #include "allocator.h"
+#include "trace.h"
 #include <string.h>
 
 /* 8 bytes header */
@@ -73,7 +74,10 @@ void allocator_init(uint8_t* pool, size_t size) {
 }
 
 void* allocator_malloc(size_t size) {
-    if (size == 0 || size > mem_capacity) return NULL;
+    if (size == 0 || size > mem_capacity) {
+        TRACE_CURRENT(TRACE_MALLOC_FAIL, TRACE_ARG_SAT(size));
+        return NULL;
+    }
     size_t aligned_size = ALIGN(size);
 
     Block* curr = head;
@@ -110,10 +114,12 @@ void* allocator_malloc(size_t size) {
             }
 
             curr->size_and_free = UPDATE_SIZE_AND_FREE(curr_size, NOT_FREE_MASK);
+            TRACE_CURRENT(TRACE_MALLOC, TRACE_ARG_SAT(size));
             return (void*)(curr + 1);
         }
         curr = curr->next;
     }
+    TRACE_CURRENT(TRACE_MALLOC_FAIL, TRACE_ARG_SAT(size));
     return NULL;
 }
 
@@ -124,6 +130,7 @@ void allocator_free(void* ptr) {
     Block* block_to_free = (Block*)ptr - 1;
     block_to_free->size_and_free |= IS_FREE_MASK;
     size_t block_mem = GET_SIZE(block_to_free->size_and_free);
+    TRACE_CURRENT(TRACE_FREE, TRACE_ARG_SAT(block_mem));
     free_mem += block_mem;
     allocated_mem -= block_mem;
     free_blocks++;
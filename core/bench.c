@@ -0,0 +1,212 @@
+#include "bench.h"
+#include "scheduler.h"
+#include "semaphore.h"
+#include "workqueue.h"
+#include "coroutine.h"
+#include "dwt.h"
+#include "utils.h"
+#include "device_registers.h"
+
+/* The ISR-to-task measurement borrows the LCD interrupt (unused on this board)
+ * and triggers it from software through NVIC_ISPR. */
+#define BENCH_SWI_IRQn  LCD_IRQn
+
+static cycle_stats_t bench_stats[BENCH_COUNT];
+static volatile uint8_t bench_armed = 0;
+
+static task_handle_t bench_partner = TASK_HANDLE_INVALID;
+static volatile uint32_t bench_isr_stamp;
+static volatile uint8_t bench_partner_done;
+static volatile bench_id_t bench_wakeup = BENCH_ISR_UNBLOCK; /* Mechanism under test */
+static semaphore_t bench_sem;
+
+static const char *const bench_names[BENCH_COUNT] = {
+    "pendsv save/restore",
+    "schedule_next_task ",
+    "wake sleeping      ",
+    "isr->task unblock  ",
+    "isr->task semaphore",
+    "isr->task notify   ",
+    "isr->work item     ",
+    "coroutine resume   ",
+};
+
+
+void bench_record(bench_id_t id, uint32_t cycles) {
+    if (bench_armed && id < BENCH_COUNT) {
+        cycle_stats_add(&bench_stats[id], cycles);
+    }
+}
+
+
+/* Deferred half of the software IRQ, run by a system work queue worker */
+static void bench_work_item(void *arg) {
+    (void)arg;
+    bench_record(BENCH_ISR_WORKQUEUE, dwt_get_cycles() - bench_isr_stamp);
+    bench_partner_done = 1;
+}
+
+
+/* Software-triggered IRQ: stamp and wake the partner with the mechanism under test */
+void LCD_IRQHandler(void) {
+    bench_isr_stamp = dwt_get_cycles();
+
+    switch (bench_wakeup) {
+        case BENCH_ISR_SEMAPHORE:
+            semaphore_give(&bench_sem);
+            break;
+        case BENCH_ISR_NOTIFY:
+            task_notify(bench_partner, 1, NOTIFY_SET_BITS);
+            break;
+        case BENCH_ISR_WORKQUEUE:
+            workqueue_submit(&workqueue_system, bench_work_item, NULL);
+            break;
+        default:
+            task_unblock(bench_partner);
+            break;
+    }
+}
+
+
+/* Parks itself; every wakeup closes one ISR-to-task sample */
+static void bench_partner_task(void *arg) {
+    bench_id_t wakeup = (bench_id_t)(uintptr_t)arg;
+
+    while (1) {
+        if (wakeup == BENCH_ISR_SEMAPHORE) {
+            semaphore_take(&bench_sem, WAIT_FOREVER);
+        } else if (wakeup == BENCH_ISR_NOTIFY) {
+            task_notify_wait(0xFFFFFFFFu, NULL, WAIT_FOREVER);
+        } else {
+            task_block_current();
+        }
+        bench_record(wakeup, dwt_get_cycles() - bench_isr_stamp);
+        bench_partner_done = 1;
+    }
+}
+
+
+/* Wait (sleeping, so SysTick and PendSV samples keep coming) until the partner is parked */
+static void bench_wait_partner_blocked(void) {
+    task_t *partner = task_from_handle(bench_partner);
+
+    while (partner != NULL && partner->state != TASK_BLOCKED) {
+        task_sleep_ticks(1);
+    }
+}
+
+
+/* One ISR-to-task phase with a fresh partner parked in the given mechanism */
+static int32_t bench_run_wakeup(bench_id_t wakeup, uint32_t iterations) {
+    int32_t handle = task_create(bench_partner_task, (void *)(uintptr_t)wakeup, STACK_SIZE_512B);
+    if (handle < 0) {
+        return -1;
+    }
+    bench_partner = (task_handle_t)handle;
+    bench_wakeup = wakeup;
+
+    /* One level above the caller, so the wakeup preempts straight out of the ISR */
+    int32_t priority = task_get_priority(task_get_current_handle()) + 1;
+    if (priority > (int32_t)TASK_PRIORITY_MAX) {
+        priority = TASK_PRIORITY_MAX;
+    }
+    task_set_priority(bench_partner, (uint8_t)priority);
+
+    for (uint32_t i = 0; i < iterations; ++i) {
+        bench_wait_partner_blocked();
+        bench_partner_done = 0;
+        nvic_set_pending(BENCH_SWI_IRQn);
+        while (!bench_partner_done) {
+            task_sleep_ticks(1);
+        }
+    }
+
+    bench_wait_partner_blocked();
+    task_delete(bench_partner);
+    bench_partner = TASK_HANDLE_INVALID;
+
+    return 0;
+}
+
+
+/* ISR-to-work-item phase: the system work queue's worker plays the partner */
+static void bench_run_workqueue(uint32_t iterations) {
+    bench_wakeup = BENCH_ISR_WORKQUEUE;
+
+    for (uint32_t i = 0; i < iterations; ++i) {
+        bench_partner_done = 0;
+        nvic_set_pending(BENCH_SWI_IRQn);
+        while (!bench_partner_done) {
+            task_sleep_ticks(1);
+        }
+    }
+}
+
+
+/* Two coroutines that only yield: every resume is one coroutine switch */
+static int8_t bench_coroutine(coroutine_t *co, void *arg) {
+    (void)arg;
+    CO_BEGIN(co);
+    while (1) {
+        CO_YIELD(co);
+    }
+    CO_END(co);
+}
+
+
+/* Driven inline by the benchmark task, so no runner task is started */
+static void bench_run_coroutines(uint32_t iterations) {
+    coroutine_sched_t sched;
+    coroutine_t co[2];
+
+    coroutine_sched_init(&sched);
+    coroutine_start(&sched, &co[0], bench_coroutine, NULL);
+    coroutine_start(&sched, &co[1], bench_coroutine, NULL);
+
+    for (uint32_t i = 0; i < iterations; ++i) {
+        uint32_t start = dwt_get_cycles();
+        uint32_t resumed = coroutine_sched_run_once(&sched, NULL);
+        bench_record(BENCH_COROUTINE_RESUME, (dwt_get_cycles() - start) / resumed);
+    }
+}
+
+
+int32_t bench_run(uint32_t iterations) {
+    int32_t status = 0;
+
+    for (uint32_t i = 0; i < BENCH_COUNT; ++i) {
+        cycle_stats_reset(&bench_stats[i]);
+    }
+    semaphore_init(&bench_sem, 0, 1);
+
+    nvic_set_priority(BENCH_SWI_IRQn, BENCH_SWI_PRIORITY);
+    nvic_enable_irq(BENCH_SWI_IRQn);
+
+    bench_armed = 1;
+    for (bench_id_t wakeup = BENCH_ISR_UNBLOCK; wakeup <= BENCH_ISR_NOTIFY && status == 0; ++wakeup) {
+        status = bench_run_wakeup(wakeup, iterations);
+    }
+    if (status == 0) {
+        bench_run_workqueue(iterations);
+        bench_run_coroutines(iterations);
+    }
+    bench_armed = 0;
+
+    nvic_disable_irq(BENCH_SWI_IRQn);
+
+    return status;
+}
+
+
+void bench_get_stats(bench_id_t id, cycle_stats_t *stats) {
+    if (id < BENCH_COUNT && stats != NULL) {
+        uint32_t state = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+        *stats = bench_stats[id];
+        exit_critical_basepri(state);
+    }
+}
+
+
+const char *bench_name(bench_id_t id) {
+    return (id < BENCH_COUNT) ? bench_names[id] : "?";
+}
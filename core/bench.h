@@ -0,0 +1,74 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "project_config.h"
+#include "cycle_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Kernel latency measurements, all in DWT cycles */
+typedef enum bench_id {
+    BENCH_PENDSV_SAVE_RESTORE = 0,  /* PendSV minus schedule_next_task: register save/restore */
+    BENCH_SCHEDULE_NEXT,            /* schedule_next_task (task selection and bookkeeping) */
+    BENCH_WAKE_SLEEPING,            /* scheduler_wake_sleeping_tasks scan from SysTick */
+    BENCH_ISR_UNBLOCK,              /* ISR entry to woken task: task_unblock() */
+    BENCH_ISR_SEMAPHORE,            /* ISR entry to woken task: semaphore_give() */
+    BENCH_ISR_NOTIFY,               /* ISR entry to woken task: task_notify() */
+    BENCH_ISR_WORKQUEUE,            /* ISR entry to start of a work item on the system work queue */
+    BENCH_COROUTINE_RESUME,         /* Coroutine runner: one yield-to-resume switch */
+    BENCH_COUNT
+} bench_id_t;
+
+
+/**
+ * @brief Record one sample if a benchmark run is in progress.
+ * 
+ * Called from the kernel probes (PendSV, SysTick and the scheduler), so it is
+ * safe from any context at or below MAX_SYSCALL_PRIORITY.
+ * 
+ * @param id Which measurement the sample belongs to
+ * @param cycles Duration in DWT cycles
+ */
+void bench_record(bench_id_t id, uint32_t cycles);
+
+
+/**
+ * @brief Run the latency benchmark.
+ * 
+ * Clears the previous results, then triggers the software IRQ 'iterations'
+ * times for each wakeup mechanism (unblock, semaphore, notification, work
+ * queue). Each trigger wakes a partner task (or a work item on the system
+ * work queue) that measures ISR-to-task latency, while the
+ * sleeping in between produces SysTick, scheduling and PendSV samples.
+ * Finally times coroutine switches on a private runner, for comparison
+ * with the PendSV ones.
+ * Must be called from a task; blocks the caller until the run is done.
+ * 
+ * @param iterations Number of ISR-to-task round trips
+ * @return 0 on success, -1 if the partner task could not be created
+ */
+int32_t bench_run(uint32_t iterations);
+
+
+/**
+ * @brief Copy the results of the last run.
+ * 
+ * @param id Measurement to read
+ * @param stats Output
+ */
+void bench_get_stats(bench_id_t id, cycle_stats_t *stats);
+
+
+/**
+ * @brief Human-readable name of a measurement.
+ */
+const char *bench_name(bench_id_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
@@ -13,6 +13,8 @@ static struct {
 
     cli_getc_fn_t   getc;
     cli_puts_fn_t   puts;
+    cli_wait_fn_t   wait;   /* Blocks until input may be available (NULL = poll) */
+    cli_write_fn_t  write;  /* Raw output for binary dumps (NULL = none) */
     const char      *prompt;
 } cli_ctx;
 
@@ -159,7 +161,7 @@ uint32_t cli_printf(const char *text, ...) {
                 int i = 0;
                 do {
                     unsigned int digit = (arg % 16);
-                    digit_buff[i++] =  digit < 10 ? '0' + digit : 'a' + digit;
+                    digit_buff[i++] = digit < 10 ? '0' + digit : 'a' + (digit - 10);
                     arg = arg / 16;
                 } while (arg > 0 && i < 10);
 
@@ -236,6 +238,27 @@ int32_t cli_init(const char *prompt, cli_getc_fn_t getc, cli_puts_fn_t puts) {
 }
 
 
+/* Set the input wait hook */
+void cli_set_input_wait(cli_wait_fn_t wait) {
+    cli_ctx.wait = wait;
+}
+
+
+/* Set the binary output hook */
+void cli_set_binary_output(cli_write_fn_t write) {
+    cli_ctx.write = write;
+}
+
+
+/* Raw bytes, bypassing the formatter */
+int cli_write(const void *data, uint32_t len) {
+    if (cli_ctx.write == NULL) {
+        return CLI_ERR;
+    }
+    return cli_ctx.write(data, len);
+}
+
+
 void cli_task_entry(void *arg) {
     (void)arg;
     char c;
@@ -248,8 +271,12 @@ void cli_task_entry(void *arg) {
         int ret = cli_ctx.getc(&c); /* 1 if char is read, 0 otherwise */
 
         if(ret == 0) {
-            /* if no char read wait for 20 ticks */
-            task_sleep_ticks(20); 
+            /* nothing buffered: block until RX signals, or poll every 20 ticks without a hook */
+            if (cli_ctx.wait) {
+                cli_ctx.wait();
+            } else {
+                task_sleep_ticks(20);
+            }
             continue;
         }
 
@@ -30,6 +30,14 @@ typedef int (*cli_cmd_fn_t)(int argc, char **argv);
 typedef int (*cli_getc_fn_t)(char *out_ch); 
 typedef int (*cli_puts_fn_t)(const char *s); 
 
+/* Input wait: blocks the CLI task until getc may have data (e.g. takes a
+ * semaphore given by the RX interrupt). Spurious returns are fine. */
+typedef void (*cli_wait_fn_t)(void);
+
+/* Raw output for binary dumps: blocks until all len bytes are queued.
+ * Returns the number of bytes written. */
+typedef int (*cli_write_fn_t)(const void *data, uint32_t len);
+
 /****** Command definition structure ******/
 typedef struct {
     const char     *name;    /* Command name (no spaces allowed) */
@@ -64,6 +72,27 @@ int32_t cli_register_command(const cli_command_t *cmd);
 int32_t cli_unregister_command(const char *name);
 
 
+/**
+ * @brief Set how the CLI task waits when no input is buffered.
+ * @param wait Blocking wait function, or NULL to poll every 20 ticks (default)
+ */
+void cli_set_input_wait(cli_wait_fn_t wait);
+
+
+/**
+ * @brief Set the raw output used by cli_write() (binary dumps).
+ * @param write Blocking byte writer, or NULL if the console cannot send binary
+ */
+void cli_set_binary_output(cli_write_fn_t write);
+
+
+/**
+ * @brief Send raw bytes to the console.
+ * @return Bytes written, or CLI_ERR if no binary output is set
+ */
+int cli_write(const void *data, uint32_t len);
+
+
 /**
  * @brief Main task loop. Pass this function to task_create().
  * This function loops forever and handles sleeping/input.
@@ -0,0 +1,144 @@
+#include "coroutine.h"
+#include "scheduler.h"
+#include "systick.h"
+#include "project_config.h"
+#include "utils.h"
+
+
+uint8_t coroutine_sleep_done(coroutine_t *co) {
+    if ((int32_t)(systick_ticks - co->wake_tick) < 0) {
+        return 0;
+    }
+    co->sleeping = 0;
+    return 1;
+}
+
+
+/* Unlink a finished coroutine; coroutine_start() may have pushed new heads meanwhile */
+static void coroutine_remove(coroutine_sched_t *sched, coroutine_t *co) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    coroutine_t **link = &sched->head;
+    while (*link != NULL && *link != co) {
+        link = &(*link)->next;
+    }
+    if (*link == co) {
+        *link = co->next;
+    }
+    co->next = NULL;
+
+    exit_critical_basepri(stat);
+}
+
+
+uint32_t coroutine_sched_run_once(coroutine_sched_t *sched, uint32_t *timeout_out) {
+    uint32_t timeout = COROUTINE_POLL_TICKS;
+    uint32_t resumed = 0;
+    coroutine_t *co = sched->head;
+
+    while (co != NULL) {
+        coroutine_t *next = co->next;
+
+        /* Sleepers are skipped without a call until their deadline */
+        if (co->sleeping) {
+            int32_t remaining = (int32_t)(co->wake_tick - systick_ticks);
+            if (remaining > 0) {
+                if ((uint32_t)remaining < timeout) {
+                    timeout = (uint32_t)remaining;
+                }
+                co = next;
+                continue;
+            }
+        }
+
+        int8_t status = co->fn(co, co->arg);
+        resumed++;
+
+        if (status == CO_ENDED) {
+            coroutine_remove(sched, co);
+        } else if (status == CO_YIELDED) {
+            timeout = 0;
+        } else if (co->sleeping) {
+            int32_t remaining = (int32_t)(co->wake_tick - systick_ticks);
+            if (remaining <= 0) {
+                timeout = 0;
+            } else if ((uint32_t)remaining < timeout) {
+                timeout = (uint32_t)remaining;
+            }
+        }
+
+        co = next;
+    }
+
+    sched->resumes += resumed;
+    if (timeout_out != NULL) {
+        *timeout_out = timeout;
+    }
+    return resumed;
+}
+
+
+static void coroutine_runner(void *arg) {
+    coroutine_sched_t *sched = (coroutine_sched_t *)arg;
+
+    while (1) {
+        uint32_t timeout;
+        coroutine_sched_run_once(sched, &timeout);
+
+        if (timeout == 0) {
+            yield_cpu();    /* Someone yielded: give equal-priority tasks a turn, then go again */
+        } else {
+            task_notify_wait(0xFFFFFFFFu, NULL, timeout);
+        }
+    }
+}
+
+
+void coroutine_sched_init(coroutine_sched_t *sched) {
+    sched->head = NULL;
+    sched->task = TASK_HANDLE_INVALID;
+    sched->resumes = 0;
+}
+
+
+int32_t coroutine_sched_start(coroutine_sched_t *sched, uint8_t priority, size_t stack_bytes) {
+    if (sched == NULL) {
+        return -1;
+    }
+
+    int32_t handle = task_create(coroutine_runner, sched, stack_bytes);
+    if (handle < 0) {
+        return -1;
+    }
+
+    sched->task = (task_handle_t)handle;
+    task_set_priority(sched->task, priority);
+    return 0;
+}
+
+
+int32_t coroutine_start(coroutine_sched_t *sched, coroutine_t *co, co_fn_t fn, void *arg) {
+    if (sched == NULL || co == NULL || fn == NULL) {
+        return -1;
+    }
+
+    co->lc = 0;
+    co->sleeping = 0;
+    co->wake_tick = 0;
+    co->fn = fn;
+    co->arg = arg;
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    co->next = sched->head;
+    sched->head = co;
+    exit_critical_basepri(stat);
+
+    coroutine_sched_wake(sched);
+    return 0;
+}
+
+
+void coroutine_sched_wake(coroutine_sched_t *sched) {
+    /* Invalid before coroutine_sched_start(): ignored, the first pass runs anyway */
+    task_notify(sched->task, 0, NOTIFY_INCREMENT);
+}
@@ -0,0 +1,156 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "scheduler.h"
+#include "systick.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Stackless coroutines
+ * ====================
+ * Protothread-style state machines that share one kernel task (the runner)
+ * and its stack. A coroutine is a function that resumes where it last
+ * waited: CO_BEGIN() switches on the saved line number, every wait point
+ * stores its own __LINE__ and returns. Resuming one is a plain function
+ * call, with no registers to save and no stack of its own, so a coroutine
+ * costs sizeof(coroutine_t) instead of a TCB plus a 512+ byte stack.
+ *
+ * Rules that come with that:
+ *  - Local variables do not survive a wait; keep state in the arg struct.
+ *  - Waits only work in the coroutine function itself, not in callees, and
+ *    not inside a switch statement of its own.
+ *  - Blocking kernel calls (mutex_lock, ...) stall every coroutine on the
+ *    runner; use the CO_AWAIT_* forms, which poll without blocking.
+ *
+ *      static int8_t blink(coroutine_t *co, void *arg) {
+ *          CO_BEGIN(co);
+ *          while (1) {
+ *              led_toggle();
+ *              CO_SLEEP(co, 500);
+ *          }
+ *          CO_END(co);
+ *      }
+ *
+ * The runner sleeps until the earliest CO_SLEEP deadline, and re-checks
+ * other wait conditions every COROUTINE_POLL_TICKS. A task or ISR that
+ * makes a condition true can call coroutine_sched_wake() to have it seen
+ * immediately.
+ */
+
+/* Return values of a coroutine function */
+#define CO_WAITING      0   /* Blocked on a condition or sleep */
+#define CO_YIELDED      1   /* Wants to run again on the next pass */
+#define CO_ENDED        2   /* Finished; removed from its runner */
+
+struct coroutine;
+typedef int8_t (*co_fn_t)(struct coroutine *co, void *arg);
+
+typedef struct coroutine {
+    uint16_t          lc;           /* Resume point (source line), 0 = start */
+    uint8_t           sleeping;     /* CO_SLEEP in progress */
+    uint32_t          wake_tick;    /* CO_SLEEP deadline */
+    co_fn_t           fn;
+    void             *arg;
+    struct coroutine *next;
+} coroutine_t;
+
+typedef struct coroutine_sched {
+    coroutine_t   *head;
+    task_handle_t  task;            /* Runner task */
+    uint32_t       resumes;         /* Coroutine function calls so far */
+} coroutine_sched_t;
+
+
+/* ---------- Coroutine body macros ---------- */
+
+#define CO_BEGIN(co)            switch ((co)->lc) { case 0:
+
+#define CO_END(co)              } (co)->lc = 0; return CO_ENDED
+
+/* Suspend until cond is true (checked on every pass of the runner) */
+#define CO_AWAIT(co, cond)                                  \
+    do {                                                    \
+        (co)->lc = (uint16_t)__LINE__; case __LINE__:       \
+        if (!(cond)) {                                      \
+            return CO_WAITING;                              \
+        }                                                   \
+    } while (0)
+
+/* Let the other coroutines (and tasks of the same priority) run once */
+#define CO_YIELD(co)                                        \
+    do {                                                    \
+        (co)->lc = (uint16_t)__LINE__;                      \
+        return CO_YIELDED; case __LINE__:;                  \
+    } while (0)
+
+#define CO_SLEEP(co, ticks)                                 \
+    do {                                                    \
+        (co)->wake_tick = systick_ticks + (ticks);          \
+        (co)->sleeping = 1;                                 \
+        CO_AWAIT(co, coroutine_sleep_done(co));             \
+    } while (0)
+
+/* Wait for event group bits; result holds the bits (see event_group_wait) */
+#define CO_AWAIT_EVENT(co, group, mask, options, result)    \
+    CO_AWAIT(co, event_group_wait((group), (mask), (options), 0, (result)) == EVENT_OK)
+
+/* Wait for a queue item, received into item */
+#define CO_AWAIT_QUEUE(co, queue, item)                     \
+    CO_AWAIT(co, queue_receive((queue), (item), 0) == QUEUE_OK)
+
+
+/**
+ * @brief Initialize an empty runner.
+ */
+void coroutine_sched_init(coroutine_sched_t *sched);
+
+
+/**
+ * @brief Create the runner task.
+ *
+ * @param priority Task priority for all of its coroutines
+ * @param stack_bytes Stack shared by all coroutines (deepest call wins)
+ * @return 0 on success, -1 if the task could not be created
+ */
+int32_t coroutine_sched_start(coroutine_sched_t *sched, uint8_t priority, size_t stack_bytes);
+
+
+/**
+ * @brief Add a coroutine to a runner; it first runs on the runner's next pass.
+ *
+ * The coroutine_t must stay valid until fn returns CO_ENDED.
+ *
+ * @return 0 on success, -1 on NULL arguments
+ */
+int32_t coroutine_start(coroutine_sched_t *sched, coroutine_t *co, co_fn_t fn, void *arg);
+
+
+/**
+ * @brief Make the runner re-check its coroutines now. Task or ISR context.
+ */
+void coroutine_sched_wake(coroutine_sched_t *sched);
+
+
+/**
+ * @brief Run one pass over the coroutines (the runner's loop body).
+ *
+ * @param timeout_out Ticks until the next CO_SLEEP deadline, capped at
+ *        COROUTINE_POLL_TICKS; 0 if a coroutine yielded
+ * @return Number of coroutines resumed
+ */
+uint32_t coroutine_sched_run_once(coroutine_sched_t *sched, uint32_t *timeout_out);
+
+
+/* Used by CO_SLEEP */
+uint8_t coroutine_sleep_done(coroutine_t *co);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COROUTINE_H */
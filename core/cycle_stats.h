@@ -0,0 +1,73 @@
+#ifndef CYCLE_STATS_H
+#define CYCLE_STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Running min/avg/max of cycle measurements */
+typedef struct cycle_stats {
+    uint32_t count;         /* Number of samples */
+    uint32_t min_cycles;    /* Smallest sample */
+    uint32_t max_cycles;    /* Largest sample */
+    uint64_t total_cycles;  /* Sum, for the average */
+} cycle_stats_t;
+
+
+/**
+ * @brief Clear all samples.
+ */
+static inline void cycle_stats_reset(cycle_stats_t *stats) {
+    stats->count = 0;
+    stats->min_cycles = 0;
+    stats->max_cycles = 0;
+    stats->total_cycles = 0;
+}
+
+
+/**
+ * @brief Add one sample.
+ */
+static inline void cycle_stats_add(cycle_stats_t *stats, uint32_t cycles) {
+    if (stats->count == 0 || cycles < stats->min_cycles) {
+        stats->min_cycles = cycles;
+    }
+    if (cycles > stats->max_cycles) {
+        stats->max_cycles = cycles;
+    }
+    stats->total_cycles += cycles;
+    stats->count++;
+}
+
+
+/**
+ * @brief num / den without a 64-bit divide, because the firmware links
+ * without libgcc.
+ * 
+ * Scales both down until num fits in 32 bits, so low bits of a large
+ * numerator are lost. Returns 0 if den is (or scales down to) 0.
+ */
+static inline uint32_t u64_div_u32(uint64_t num, uint32_t den) {
+    while ((num >> 32) != 0) {
+        num >>= 1;
+        den >>= 1;
+    }
+    return (den == 0) ? 0 : (uint32_t)num / den;
+}
+
+
+/**
+ * @brief Average of the samples.
+ */
+static inline uint32_t cycle_stats_avg(const cycle_stats_t *stats) {
+    return u64_div_u32(stats->total_cycles, stats->count);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYCLE_STATS_H */
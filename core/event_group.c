@@ -0,0 +1,122 @@
+#include "event_group.h"
+#include "utils.h"
+
+
+/* Does the group state satisfy a waiter? */
+static uint8_t event_match(uint32_t bits, uint32_t mask, uint8_t options) {
+    if (options & EVENT_WAIT_ALL) {
+        return (bits & mask) == mask;
+    }
+    return (bits & mask) != 0;
+}
+
+
+void event_group_init(event_group_t *group) {
+    if (group == NULL) {
+        return;
+    }
+
+    group->bits = 0;
+    wait_queue_init(&group->waiters);
+}
+
+
+uint32_t event_group_set(event_group_t *group, uint32_t bits) {
+    if (group == NULL) {
+        return 0;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    group->bits |= bits;
+
+    /* One pass over the waiters; clears are applied afterwards so every match sees the same bits */
+    uint32_t clear_mask = 0;
+    task_t *waiter = group->waiters.head;
+
+    while (waiter != NULL) {
+        task_t *next = waiter->wait_next;  /* Waking unlinks the waiter */
+
+        if (event_match(group->bits, waiter->event_mask, waiter->event_options)) {
+            waiter->event_bits = group->bits;
+            if (waiter->event_options & EVENT_CLEAR_ON_EXIT) {
+                clear_mask |= waiter->event_mask;
+            }
+            wait_queue_wake_task(waiter, WAIT_OK);
+        }
+        waiter = next;
+    }
+
+    group->bits &= ~clear_mask;
+    uint32_t result = group->bits;
+
+    exit_critical_basepri(stat);
+
+    return result;
+}
+
+
+uint32_t event_group_clear(event_group_t *group, uint32_t bits) {
+    if (group == NULL) {
+        return 0;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    uint32_t previous = group->bits;
+    group->bits &= ~bits;
+    exit_critical_basepri(stat);
+
+    return previous;
+}
+
+
+uint32_t event_group_get(const event_group_t *group) {
+    return (group != NULL) ? group->bits : 0;
+}
+
+
+int32_t event_group_wait(event_group_t *group, uint32_t mask, uint8_t options,
+                         uint32_t timeout_ticks, uint32_t *bits_out) {
+    if (group == NULL || mask == 0) {
+        return EVENT_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (event_match(group->bits, mask, options)) {
+        if (bits_out != NULL) {
+            *bits_out = group->bits;
+        }
+        if (options & EVENT_CLEAR_ON_EXIT) {
+            group->bits &= ~mask;
+        }
+        exit_critical_basepri(stat);
+        return EVENT_OK;
+    }
+
+    if (timeout_ticks == 0) {
+        exit_critical_basepri(stat);
+        return EVENT_ERR_TIMEOUT;
+    }
+
+    if (in_isr() || task_current == NULL) {
+        exit_critical_basepri(stat);
+        return EVENT_ERR_ISR;
+    }
+
+    /* event_group_set() evaluates the condition and records the bits for us */
+    task_current->event_mask = mask;
+    task_current->event_options = options;
+    task_current->event_bits = 0;
+
+    int32_t result = task_wait(&group->waiters, timeout_ticks, stat);
+
+    if (result != WAIT_OK) {
+        return (result == WAIT_TIMEOUT) ? EVENT_ERR_TIMEOUT : EVENT_ERR_ABORTED;
+    }
+
+    if (bits_out != NULL) {
+        *bits_out = task_current->event_bits;
+    }
+    return EVENT_OK;
+}
@@ -0,0 +1,89 @@
+#ifndef EVENT_GROUP_H
+#define EVENT_GROUP_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Event groups
+ * ============
+ * 32 event flags that tasks can wait on in combination: any of a mask, or
+ * all of it, with a timeout. Setting bits (from a task or an ISR at or below
+ * MAX_SYSCALL_PRIORITY) walks the waiters once and wakes every task whose
+ * condition now holds. Waiters that asked for EVENT_CLEAR_ON_EXIT have their
+ * bits cleared after that pass, so all waiters released by the same set see
+ * the same flags.
+ */
+
+/* event_group_wait() options */
+#define EVENT_WAIT_ANY          0x00u   /* Any bit of the mask (default) */
+#define EVENT_WAIT_ALL          0x01u   /* Every bit of the mask */
+#define EVENT_CLEAR_ON_EXIT     0x02u   /* Clear the mask bits when the wait is satisfied */
+
+typedef enum event_status {
+    EVENT_OK            = 0,
+    EVENT_ERR_TIMEOUT   = -1,   /* Condition not met before the timeout */
+    EVENT_ERR_PARAM     = -2,   /* NULL group or empty mask */
+    EVENT_ERR_ISR       = -3,   /* Blocking wait from an interrupt handler */
+    EVENT_ERR_ABORTED   = -4    /* Wait cut short by task_unblock() */
+} event_status_t;
+
+typedef struct event_group {
+    uint32_t     bits;
+    wait_queue_t waiters;
+} event_group_t;
+
+
+/**
+ * @brief Initialize an event group with all bits clear.
+ */
+void event_group_init(event_group_t *group);
+
+
+/**
+ * @brief Set bits and wake every waiter whose condition is now met.
+ * 
+ * Task or ISR context.
+ * 
+ * @return Group bits after the call (after any clear-on-exit)
+ */
+uint32_t event_group_set(event_group_t *group, uint32_t bits);
+
+
+/**
+ * @brief Clear bits. Task or ISR context.
+ * 
+ * @return Group bits before the call
+ */
+uint32_t event_group_clear(event_group_t *group, uint32_t bits);
+
+
+/**
+ * @brief Current bits.
+ */
+uint32_t event_group_get(const event_group_t *group);
+
+
+/**
+ * @brief Wait until any/all bits of mask are set.
+ * 
+ * From an ISR only timeout_ticks = 0 (poll) is allowed.
+ * 
+ * @param mask Bits of interest (non-zero)
+ * @param options EVENT_WAIT_ANY or EVENT_WAIT_ALL, optionally | EVENT_CLEAR_ON_EXIT
+ * @param timeout_ticks SysTick ticks to wait, 0 to not wait, WAIT_FOREVER to block
+ * @param bits_out Group bits that satisfied the wait, before clearing (may be NULL)
+ * @return EVENT_OK or a negative event_status_t
+ */
+int32_t event_group_wait(event_group_t *group, uint32_t mask, uint8_t options,
+                         uint32_t timeout_ticks, uint32_t *bits_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_GROUP_H */
@@ -0,0 +1,280 @@
+#include "mutex.h"
+#include "systick.h"
+#include "utils.h"
+
+static mutex_t *mutex_registry = NULL;
+
+
+/* Make task the owner and push the mutex onto its held list */
+static void mutex_take(mutex_t *mutex, task_t *task) {
+    mutex->owner = task;
+    mutex->next_held = task->mutex_held;
+    task->mutex_held = mutex;
+}
+
+
+/* Unlink the mutex from its owner's held list */
+static void mutex_release(mutex_t *mutex) {
+    task_t *owner = mutex->owner;
+
+    for (mutex_t **link = &owner->mutex_held; *link != NULL; link = &(*link)->next_held) {
+        if (*link == mutex) {
+            *link = mutex->next_held;
+            break;
+        }
+    }
+    mutex->next_held = NULL;
+    mutex->owner = NULL;
+}
+
+
+/* Base priority, raised to the best waiter of every mutex the task holds */
+static uint8_t mutex_inherited_priority(const task_t *task) {
+    uint8_t priority = task->base_priority;
+
+    for (const mutex_t *held = task->mutex_held; held != NULL; held = held->next_held) {
+        /* Waiters are sorted, so the head is the most urgent */
+        const task_t *waiter = held->waiters.head;
+        if (waiter != NULL && waiter->priority > priority) {
+            priority = waiter->priority;
+        }
+    }
+
+    return priority;
+}
+
+
+/* 
+ * Bring the owner of a mutex to the priority its waiters require, then
+ * follow the chain if that owner is itself blocked on another mutex.
+ * Works in both directions: boosting when a waiter arrives, dropping when
+ * one gives up.
+ */
+static void mutex_propagate(mutex_t *mutex) {
+    for (uint32_t depth = 0; depth < MUTEX_INHERIT_DEPTH && mutex != NULL; ++depth) {
+        task_t *owner = mutex->owner;
+        if (owner == NULL) {
+            break;
+        }
+
+        uint8_t priority = mutex_inherited_priority(owner);
+        if (priority == owner->priority) {
+            break;
+        }
+        if (priority > owner->priority) {
+            mutex->stats.inheritances++;
+        }
+
+        task_set_effective_priority(owner, priority);
+        mutex = owner->mutex_blocked_on;
+    }
+}
+
+
+int32_t mutex_init(mutex_t *mutex, const char *name) {
+    if (mutex == NULL) {
+        return MUTEX_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    mutex->name = name;
+    mutex->owner = NULL;
+    mutex->next_held = NULL;
+    wait_queue_init(&mutex->waiters);
+    memset(&mutex->stats, 0, sizeof(mutex->stats));
+
+    /* Re-initializing must not link the mutex into the registry twice */
+    mutex_t *it = mutex_registry;
+    while (it != NULL && it != mutex) {
+        it = it->next;
+    }
+    if (it == NULL) {
+        mutex->next = mutex_registry;
+        mutex_registry = mutex;
+    }
+
+    exit_critical_basepri(stat);
+
+    return MUTEX_OK;
+}
+
+
+int32_t mutex_lock(mutex_t *mutex) {
+    return mutex_lock_timeout(mutex, WAIT_FOREVER);
+}
+
+
+int32_t mutex_trylock(mutex_t *mutex) {
+    return mutex_lock_timeout(mutex, 0);
+}
+
+
+int32_t mutex_lock_timeout(mutex_t *mutex, uint32_t timeout_ticks) {
+    if (mutex == NULL) {
+        return MUTEX_ERR_PARAM;
+    }
+    if (in_isr()) {
+        return MUTEX_ERR_ISR;
+    }
+    if (task_current == NULL) {
+        return MUTEX_OK; /* Scheduler not running yet: nobody to exclude */
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    task_t *self = task_current;
+
+    if (mutex->owner == NULL) {
+        mutex_take(mutex, self);
+        mutex->stats.locks++;
+        exit_critical_basepri(stat);
+        return MUTEX_OK;
+    }
+
+    if (mutex->owner == self) {
+        exit_critical_basepri(stat);
+        return MUTEX_ERR_DEADLOCK;
+    }
+
+    if (timeout_ticks == 0) {
+        exit_critical_basepri(stat);
+        return MUTEX_ERR_TIMEOUT;
+    }
+
+    /* Block, lending our priority to the owner (and whoever it waits for) */
+    mutex->stats.contentions++;
+    self->mutex_blocked_on = mutex;
+    uint32_t wait_start = systick_ticks;
+
+    task_wait_begin(&mutex->waiters, timeout_ticks);
+    mutex_propagate(mutex);
+    int32_t result = task_wait_end(stat);
+
+    stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    uint32_t waited = systick_ticks - wait_start;
+    if (waited > mutex->stats.max_wait_ticks) {
+        mutex->stats.max_wait_ticks = waited;
+    }
+
+    if (result == WAIT_OK) {
+        /* mutex_unlock() already made us the owner */
+        mutex->stats.locks++;
+        exit_critical_basepri(stat);
+        return MUTEX_OK;
+    }
+
+    /* Gave up: the owner no longer needs to run at our priority */
+    self->mutex_blocked_on = NULL;
+    if (result == WAIT_TIMEOUT) {
+        mutex->stats.timeouts++;
+    }
+    mutex_propagate(mutex);
+
+    exit_critical_basepri(stat);
+
+    return (result == WAIT_TIMEOUT) ? MUTEX_ERR_TIMEOUT : MUTEX_ERR_ABORTED;
+}
+
+
+int32_t mutex_unlock(mutex_t *mutex) {
+    if (mutex == NULL) {
+        return MUTEX_ERR_PARAM;
+    }
+    if (in_isr()) {
+        return MUTEX_ERR_ISR;
+    }
+    if (task_current == NULL) {
+        return MUTEX_OK;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    task_t *self = task_current;
+
+    if (mutex->owner != self) {
+        exit_critical_basepri(stat);
+        return MUTEX_ERR_NOT_OWNER;
+    }
+
+    mutex_release(mutex);
+
+    /* Drop whatever was inherited through this mutex */
+    uint8_t old_priority = self->priority;
+    task_set_effective_priority(self, mutex_inherited_priority(self));
+
+    /* Hand over directly; the new owner's priority already covers the remaining waiters */
+    task_t *next = wait_queue_wake_one(&mutex->waiters, WAIT_OK);
+    if (next != NULL) {
+        next->mutex_blocked_on = NULL;
+        mutex_take(mutex, next);
+    }
+
+    if (self->priority < old_priority) {
+        yield_cpu(); /* A task between our old and new priority may be ready */
+    }
+
+    exit_critical_basepri(stat);
+
+    return MUTEX_OK;
+}
+
+
+void mutex_waiter_repropagate(task_t *task) {
+    if (task->mutex_blocked_on != NULL) {
+        mutex_propagate(task->mutex_blocked_on);
+    }
+}
+
+
+void mutex_task_gone(task_t *task) {
+    /* A waiter leaving takes its priority loan with it */
+    mutex_t *blocked_on = task->mutex_blocked_on;
+    if (blocked_on != NULL) {
+        task->mutex_blocked_on = NULL;
+        mutex_propagate(blocked_on);
+    }
+
+    /* Hand every held mutex to its top waiter, as mutex_unlock() would */
+    while (task->mutex_held != NULL) {
+        mutex_t *mutex = task->mutex_held;
+        mutex_release(mutex);
+
+        task_t *next = wait_queue_wake_one(&mutex->waiters, WAIT_OK);
+        if (next != NULL) {
+            next->mutex_blocked_on = NULL;
+            mutex_take(mutex, next);
+        }
+    }
+}
+
+
+int32_t mutex_get_info(uint32_t index, mutex_info_t *info) {
+    if (info == NULL) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    mutex_t *mutex = mutex_registry;
+    while (mutex != NULL && index > 0) {
+        mutex = mutex->next;
+        index--;
+    }
+
+    if (mutex == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    info->name = mutex->name;
+    info->owner = (mutex->owner != NULL) ? mutex->owner->handle : TASK_HANDLE_INVALID;
+    info->waiters = 0;
+    for (const task_t *waiter = mutex->waiters.head; waiter != NULL; waiter = waiter->wait_next) {
+        info->waiters++;
+    }
+    info->stats = mutex->stats;
+
+    exit_critical_basepri(stat);
+
+    return 0;
+}
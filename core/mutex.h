@@ -0,0 +1,146 @@
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Kernel mutex with priority inheritance
+ * ======================================
+ * A task that finds the mutex locked blocks on it instead of spinning.
+ * Waiters are served in priority order and unlock hands ownership straight
+ * to the first one, so a late-arriving task cannot barge in.
+ *
+ * While a task waits, the owner runs at least at the waiter's priority, and
+ * the boost is passed along if the owner itself waits on another mutex
+ * (up to MUTEX_INHERIT_DEPTH owners). This bounds priority inversion to the
+ * length of the critical sections involved.
+ *
+ * Mutexes are not recursive and may only be used from tasks. When a task
+ * that holds a mutex exits or is deleted, the mutex passes to its top waiter
+ * (or is left unlocked) and the data it guards may be half-updated.
+ */
+
+/* How many owners a priority boost is passed through (also breaks deadlock cycles) */
+#define MUTEX_INHERIT_DEPTH     8u
+
+typedef enum mutex_status {
+    MUTEX_OK            = 0,
+    MUTEX_ERR_TIMEOUT   = -1,   /* Still locked when the timeout expired (or trylock) */
+    MUTEX_ERR_PARAM     = -2,   /* NULL mutex */
+    MUTEX_ERR_NOT_OWNER = -3,   /* Unlock by a task that does not hold it */
+    MUTEX_ERR_DEADLOCK  = -4,   /* Lock by the task that already holds it */
+    MUTEX_ERR_ISR       = -5,   /* Called from an interrupt handler */
+    MUTEX_ERR_ABORTED   = -6    /* Wait cut short by task_unblock() */
+} mutex_status_t;
+
+/* Contention statistics, cumulative since mutex_init() */
+typedef struct mutex_stats {
+    uint32_t locks;             /* Successful acquisitions */
+    uint32_t contentions;       /* Acquisitions that had to block */
+    uint32_t timeouts;          /* Blocking attempts that gave up */
+    uint32_t inheritances;      /* Times an owner was boosted by a waiter */
+    uint32_t max_wait_ticks;    /* Longest time a task spent blocked */
+} mutex_stats_t;
+
+typedef struct mutex {
+    const char    *name;        /* Shown by the 'mutex' command */
+    task_t        *owner;       /* NULL when unlocked */
+    wait_queue_t   waiters;
+    struct mutex  *next_held;   /* Next mutex in the owner's held list */
+    struct mutex  *next;        /* Registry of all mutexes */
+    mutex_stats_t  stats;
+} mutex_t;
+
+/* Snapshot of one mutex for diagnostics */
+typedef struct mutex_info {
+    const char    *name;
+    task_handle_t  owner;       /* TASK_HANDLE_INVALID when unlocked */
+    uint32_t       waiters;
+    mutex_stats_t  stats;
+} mutex_info_t;
+
+
+/**
+ * @brief Initialize a mutex (unlocked) and add it to the registry.
+ * 
+ * @param mutex Mutex to initialize; must stay allocated for the lifetime of the system
+ * @param name Name for diagnostics (not copied)
+ * @return MUTEX_OK, or MUTEX_ERR_PARAM if mutex is NULL
+ */
+int32_t mutex_init(mutex_t *mutex, const char *name);
+
+
+/**
+ * @brief Lock, blocking for as long as it takes.
+ * 
+ * @return MUTEX_OK or a negative mutex_status_t
+ */
+int32_t mutex_lock(mutex_t *mutex);
+
+
+/**
+ * @brief Lock only if the mutex is free right now.
+ * 
+ * @return MUTEX_OK, or MUTEX_ERR_TIMEOUT if it is held
+ */
+int32_t mutex_trylock(mutex_t *mutex);
+
+
+/**
+ * @brief Lock, blocking for at most timeout_ticks.
+ * 
+ * @param timeout_ticks SysTick ticks to wait, 0 to not wait, WAIT_FOREVER to block
+ * @return MUTEX_OK or a negative mutex_status_t
+ */
+int32_t mutex_lock_timeout(mutex_t *mutex, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Unlock. Ownership passes to the highest-priority waiter, if any.
+ * 
+ * Drops any priority the caller inherited through this mutex.
+ * 
+ * @return MUTEX_OK, or MUTEX_ERR_NOT_OWNER if the caller does not hold it
+ */
+int32_t mutex_unlock(mutex_t *mutex);
+
+
+/**
+ * @brief Pass a waiter's new priority on to the owner it waits for.
+ * 
+ * Kernel-internal, called by task_set_priority(). Does nothing if the task
+ * is not blocked on a mutex. Caller holds the critical section.
+ */
+void mutex_waiter_repropagate(task_t *task);
+
+
+/**
+ * @brief Release everything a dying task holds and withdraw it as a waiter.
+ * 
+ * Kernel-internal, called by the scheduler as the task ends. Held mutexes go
+ * to their top waiter; if the task was blocked, the owner's boost is
+ * recomputed. Caller holds the critical section and has already unlinked
+ * the task from the wait queue.
+ */
+void mutex_task_gone(task_t *task);
+
+
+/**
+ * @brief Get a snapshot of the index-th registered mutex.
+ * 
+ * @param index 0 .. number of mutexes - 1 (registration order, newest first)
+ * @param info Output
+ * @return 0 on success, -1 if index is past the end
+ */
+int32_t mutex_get_info(uint32_t index, mutex_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MUTEX_H */
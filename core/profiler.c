@@ -0,0 +1,133 @@
+#include <stddef.h>
+#include "profiler.h"
+#include "project_config.h"
+#include "basic_timer.h"
+#include "utils.h"
+
+#if PROFILER
+
+extern uint32_t _stext;     /* Linker script: start and end of code in FLASH */
+extern uint32_t _etext;
+
+static uint16_t profiler_bins[PROFILER_BINS];
+
+static uint32_t profiler_base;
+static uint32_t profiler_span;
+static uint8_t  profiler_shift;
+static uint8_t  profiler_running;
+static uint32_t profiler_rate_hz;
+
+static volatile uint32_t profiler_samples;
+static volatile uint32_t profiler_outside;
+static volatile uint32_t profiler_saturated;
+
+
+/* Smallest power-of-two bin (at least one Thumb halfword) that covers .text */
+static void profiler_layout(void) {
+    profiler_base = (uint32_t)&_stext;
+    profiler_span = (uint32_t)&_etext - profiler_base;
+    profiler_shift = 1;
+    while ((profiler_span >> profiler_shift) >= PROFILER_BINS) {
+        profiler_shift++;
+    }
+}
+
+
+/* Called from TIM7_IRQHandler (context_switch.S) with the interrupted frame */
+void profiler_sample(const uint32_t *frame) {
+    basic_timer_clear_update(TIM7);
+
+    uint32_t offset = frame[6] - profiler_base;    /* Stacked PC */
+    profiler_samples++;
+
+    if (offset >= profiler_span) {
+        profiler_outside++;
+        return;
+    }
+
+    uint16_t *bin = &profiler_bins[offset >> profiler_shift];
+    if (*bin == 0xFFFFu) {
+        return;
+    }
+    if (++(*bin) == 0xFFFFu) {
+        profiler_saturated++;
+    }
+}
+
+
+int32_t profiler_start(uint32_t rate_hz) {
+    if (rate_hz < PROFILER_MIN_HZ || rate_hz > PROFILER_MAX_HZ) {
+        return -1;
+    }
+
+    if (profiler_span == 0) {
+        profiler_layout();
+    }
+
+    profiler_stop();
+    if (basic_timer_start(TIM7, rate_hz) != 0) {
+        return -1;
+    }
+
+    profiler_rate_hz = rate_hz;
+    profiler_running = 1;
+    nvic_set_priority(TIM7_IRQn, PROFILER_IRQ_PRIORITY);
+    nvic_enable_irq(TIM7_IRQn);
+
+    return 0;
+}
+
+
+void profiler_stop(void) {
+    if (!profiler_running) {
+        return;
+    }
+    nvic_disable_irq(TIM7_IRQn);
+    basic_timer_stop(TIM7);
+    profiler_running = 0;
+}
+
+
+void profiler_clear(void) {
+    /* The sampler runs above BASEPRI, so only PRIMASK keeps it out */
+    uint32_t stat = enter_critical_primask();
+
+    for (uint32_t i = 0; i < PROFILER_BINS; ++i) {
+        profiler_bins[i] = 0;
+    }
+    profiler_samples = 0;
+    profiler_outside = 0;
+    profiler_saturated = 0;
+
+    exit_critical_primask(stat);
+}
+
+
+void profiler_get_info(profiler_info_t *info) {
+    if (info == NULL) {
+        return;
+    }
+
+    if (profiler_span == 0) {
+        profiler_layout();
+    }
+
+    info->running = profiler_running;
+    info->rate_hz = profiler_rate_hz;
+    info->base = profiler_base;
+    info->bin_bytes = 1UL << profiler_shift;
+    info->bins = (profiler_span + info->bin_bytes - 1U) >> profiler_shift;
+    info->samples = profiler_samples;
+    info->outside = profiler_outside;
+    info->saturated = profiler_saturated;
+}
+
+
+uint16_t profiler_bin_count(uint32_t index) {
+    if (index >= PROFILER_BINS) {
+        return 0;
+    }
+    return profiler_bins[index];
+}
+
+#endif /* PROFILER */
@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Statistical PC-sampling profiler
+ * ================================
+ * TIM7 interrupts at a fixed rate and the handler reads the program counter
+ * stacked by the interrupted context (task, ISR or idle). Samples land in
+ * PROFILER_BINS 16-bit counters covering .text evenly, so a bin is an
+ * address range of 2^n bytes. 'prof dump' prints the non-empty bins and
+ * scripts/prof_symbolize.py maps them onto functions with the linker map.
+ *
+ * The interrupt runs above MAX_SYSCALL_PRIORITY, so time spent inside kernel
+ * critical sections is sampled too; only PRIMASK sections are invisible.
+ */
+
+typedef struct profiler_info {
+    uint8_t  running;
+    uint32_t rate_hz;       /* Sampling rate actually programmed */
+    uint32_t base;          /* Address of bin 0 (start of .text) */
+    uint32_t bin_bytes;     /* Address range per bin */
+    uint32_t bins;          /* Bins in use */
+    uint32_t samples;       /* All samples since the last clear */
+    uint32_t outside;       /* PC outside .text (RAM code, bad frames) */
+    uint32_t saturated;     /* Bins that hit 0xFFFF and stopped counting */
+} profiler_info_t;
+
+
+/**
+ * @brief Start sampling at rate_hz (PROFILER_MIN_HZ .. PROFILER_MAX_HZ).
+ *
+ * Keeps existing counts; use profiler_clear() for a fresh profile.
+ *
+ * @return 0 on success, -1 if the rate is out of range
+ */
+int32_t profiler_start(uint32_t rate_hz);
+
+
+/**
+ * @brief Stop sampling; counts are kept for dumping.
+ */
+void profiler_stop(void);
+
+
+/**
+ * @brief Zero all bins and counters.
+ */
+void profiler_clear(void);
+
+
+/**
+ * @brief Snapshot of the profiler state.
+ */
+void profiler_get_info(profiler_info_t *info);
+
+
+/**
+ * @brief Sample count of one bin, 0 past the last bin.
+ */
+uint16_t profiler_bin_count(uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
@@ -0,0 +1,298 @@
+#include "queue.h"
+#include "systick.h"
+#include "utils.h"
+
+static queue_t *queue_registry = NULL;
+
+
+/* Items visible to receivers; a reserved slot is always the newest one */
+static uint32_t queue_committed(const queue_t *queue) {
+    return queue->used - queue->reserved;
+}
+
+
+static uint8_t *queue_slot(const queue_t *queue, uint32_t index) {
+    return queue->storage + index * queue->item_size;
+}
+
+
+/* Claim the tail slot (used++), keeping the high-water mark */
+static uint8_t *queue_claim_tail(queue_t *queue) {
+    uint8_t *slot = queue_slot(queue, queue->tail);
+
+    queue->tail = (queue->tail + 1U == queue->capacity) ? 0 : queue->tail + 1U;
+    queue->used++;
+    if (queue->used > queue->stats.high_water) {
+        queue->stats.high_water = queue->used;
+    }
+
+    return slot;
+}
+
+
+/* Space for a new item, and no reservation that would have to stay in front of it */
+static uint8_t queue_can_send(const queue_t *queue) {
+    return !queue->reserved && queue->used < queue->capacity;
+}
+
+
+/* 
+ * Block on a wait list with what is left of the caller's timeout.
+ * Waiters re-check the queue after every wakeup (another task may have
+ * taken the slot first), so the deadline is tracked across rounds.
+ */
+static int32_t queue_wait(wait_queue_t *waiters, uint32_t timeout_ticks,
+                          uint32_t start_tick, uint32_t stat) {
+    uint32_t remaining = WAIT_FOREVER;
+
+    if (timeout_ticks != WAIT_FOREVER) {
+        uint32_t elapsed = systick_ticks - start_tick;
+        if (elapsed >= timeout_ticks) {
+            exit_critical_basepri(stat);
+            return WAIT_TIMEOUT;
+        }
+        remaining = timeout_ticks - elapsed;
+    }
+
+    return task_wait(waiters, remaining, stat);
+}
+
+
+/* Wait until a send/reserve may proceed. Returns with BASEPRI raised on QUEUE_OK only. */
+static int32_t queue_wait_for_space(queue_t *queue, uint32_t timeout_ticks, uint32_t *stat) {
+    uint32_t start_tick = systick_ticks;
+
+    while (!queue_can_send(queue)) {
+        if (timeout_ticks == 0 || in_isr() || task_current == NULL) {
+            queue->stats.send_fails++;
+            exit_critical_basepri(*stat);
+            return (timeout_ticks == 0) ? QUEUE_ERR_TIMEOUT : QUEUE_ERR_ISR;
+        }
+
+        int32_t result = queue_wait(&queue->not_full, timeout_ticks, start_tick, *stat);
+        *stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+        if (result == WAIT_TIMEOUT || result == WAIT_ABORTED) {
+            queue->stats.send_fails++;
+            exit_critical_basepri(*stat);
+            return (result == WAIT_TIMEOUT) ? QUEUE_ERR_TIMEOUT : QUEUE_ERR_ABORTED;
+        }
+    }
+
+    return QUEUE_OK;
+}
+
+
+int32_t queue_init(queue_t *queue, const char *name, void *storage,
+                   uint32_t item_size, uint32_t capacity) {
+    if (queue == NULL || storage == NULL || item_size == 0 || capacity == 0) {
+        return QUEUE_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    queue->name = name;
+    queue->storage = (uint8_t *)storage;
+    queue->item_size = item_size;
+    queue->capacity = capacity;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->used = 0;
+    queue->reserved = 0;
+    wait_queue_init(&queue->not_full);
+    wait_queue_init(&queue->not_empty);
+    memset(&queue->stats, 0, sizeof(queue->stats));
+
+    /* Re-initializing must not link the queue into the registry twice */
+    queue_t *it = queue_registry;
+    while (it != NULL && it != queue) {
+        it = it->next;
+    }
+    if (it == NULL) {
+        queue->next = queue_registry;
+        queue_registry = queue;
+    }
+
+    exit_critical_basepri(stat);
+
+    return QUEUE_OK;
+}
+
+
+int32_t queue_send(queue_t *queue, const void *item, uint32_t timeout_ticks) {
+    if (queue == NULL || item == NULL) {
+        return QUEUE_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    int32_t status = queue_wait_for_space(queue, timeout_ticks, &stat);
+    if (status != QUEUE_OK) {
+        return status;
+    }
+
+    memcpy(queue_claim_tail(queue), item, queue->item_size);
+    queue->stats.sends++;
+    wait_queue_wake_one(&queue->not_empty, WAIT_OK);
+
+    exit_critical_basepri(stat);
+
+    return QUEUE_OK;
+}
+
+
+int32_t queue_receive(queue_t *queue, void *item, uint32_t timeout_ticks) {
+    if (queue == NULL || item == NULL) {
+        return QUEUE_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    uint32_t start_tick = systick_ticks;
+
+    while (queue_committed(queue) == 0) {
+        if (timeout_ticks == 0) {
+            exit_critical_basepri(stat);
+            return QUEUE_ERR_TIMEOUT;
+        }
+        if (in_isr() || task_current == NULL) {
+            exit_critical_basepri(stat);
+            return QUEUE_ERR_ISR;
+        }
+
+        int32_t result = queue_wait(&queue->not_empty, timeout_ticks, start_tick, stat);
+        if (result == WAIT_TIMEOUT) {
+            return QUEUE_ERR_TIMEOUT;
+        }
+        if (result == WAIT_ABORTED) {
+            return QUEUE_ERR_ABORTED;
+        }
+        stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    }
+
+    memcpy(item, queue_slot(queue, queue->head), queue->item_size);
+    queue->head = (queue->head + 1U == queue->capacity) ? 0 : queue->head + 1U;
+    queue->used--;
+    queue->stats.receives++;
+    wait_queue_wake_one(&queue->not_full, WAIT_OK);
+
+    exit_critical_basepri(stat);
+
+    return QUEUE_OK;
+}
+
+
+int32_t queue_send_from_isr(queue_t *queue, const void *item) {
+    return queue_send(queue, item, 0);
+}
+
+
+int32_t queue_receive_from_isr(queue_t *queue, void *item) {
+    return queue_receive(queue, item, 0);
+}
+
+
+void *queue_reserve(queue_t *queue, uint32_t timeout_ticks) {
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (queue_wait_for_space(queue, timeout_ticks, &stat) != QUEUE_OK) {
+        return NULL;
+    }
+
+    /* Counted in used (so nobody else can take it) but not yet visible */
+    void *slot = queue_claim_tail(queue);
+    queue->reserved = 1;
+
+    exit_critical_basepri(stat);
+
+    return slot;
+}
+
+
+int32_t queue_commit(queue_t *queue) {
+    if (queue == NULL) {
+        return QUEUE_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (!queue->reserved) {
+        exit_critical_basepri(stat);
+        return QUEUE_ERR_NO_RESERVATION;
+    }
+
+    queue->reserved = 0;
+    queue->stats.sends++;
+    wait_queue_wake_one(&queue->not_empty, WAIT_OK);
+
+    /* Senders held back by the reservation may go on if there is room */
+    if (queue->used < queue->capacity) {
+        wait_queue_wake_one(&queue->not_full, WAIT_OK);
+    }
+
+    exit_critical_basepri(stat);
+
+    return QUEUE_OK;
+}
+
+
+int32_t queue_cancel(queue_t *queue) {
+    if (queue == NULL) {
+        return QUEUE_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (!queue->reserved) {
+        exit_critical_basepri(stat);
+        return QUEUE_ERR_NO_RESERVATION;
+    }
+
+    /* The reserved slot is the newest, so un-claiming the tail is enough */
+    queue->tail = (queue->tail == 0) ? queue->capacity - 1U : queue->tail - 1U;
+    queue->used--;
+    queue->reserved = 0;
+    wait_queue_wake_one(&queue->not_full, WAIT_OK);
+
+    exit_critical_basepri(stat);
+
+    return QUEUE_OK;
+}
+
+
+uint32_t queue_count(const queue_t *queue) {
+    return (queue != NULL) ? queue_committed(queue) : 0;
+}
+
+
+int32_t queue_get_info(uint32_t index, queue_info_t *info) {
+    if (info == NULL) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    queue_t *queue = queue_registry;
+    while (queue != NULL && index > 0) {
+        queue = queue->next;
+        index--;
+    }
+
+    if (queue == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    info->name = queue->name;
+    info->item_size = queue->item_size;
+    info->capacity = queue->capacity;
+    info->used = queue->used;
+    info->stats = queue->stats;
+
+    exit_critical_basepri(stat);
+
+    return 0;
+}
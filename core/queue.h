@@ -0,0 +1,164 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Message queues
+ * ==============
+ * Fixed-size items in a caller-provided ring buffer. Senders block on the
+ * queue's not_full wait list while it is full and receivers on not_empty
+ * while it is empty, both with an optional timeout. The _from_isr variants
+ * never block and are safe from ISRs at or below MAX_SYSCALL_PRIORITY.
+ *
+ * Zero-copy sending: queue_reserve() returns a pointer to the next free slot
+ * inside the queue storage, the producer fills it in place and publishes it
+ * with queue_commit() (or drops it with queue_cancel()). One reservation can
+ * be outstanding per queue; other senders wait until it is committed, so
+ * items are always delivered in order.
+ */
+
+typedef enum queue_status {
+    QUEUE_OK                 = 0,
+    QUEUE_ERR_TIMEOUT        = -1,  /* Full (send) or empty (receive) until the timeout */
+    QUEUE_ERR_PARAM          = -2,  /* NULL queue/item, zero size or capacity */
+    QUEUE_ERR_ISR            = -3,  /* Blocking call from an interrupt handler */
+    QUEUE_ERR_NO_RESERVATION = -4,  /* commit/cancel without a reserved slot */
+    QUEUE_ERR_ABORTED        = -5   /* Wait cut short by task_unblock() */
+} queue_status_t;
+
+/* Statistics, cumulative since queue_init() */
+typedef struct queue_stats {
+    uint32_t sends;         /* Items delivered (send or commit) */
+    uint32_t receives;      /* Items taken out */
+    uint32_t send_fails;    /* Sends/reserves that found the queue full until their timeout */
+    uint32_t high_water;    /* Most slots ever in use (including a reservation) */
+} queue_stats_t;
+
+typedef struct queue {
+    const char   *name;         /* Shown by the 'queues' command */
+    uint8_t      *storage;      /* capacity * item_size bytes */
+    uint32_t      item_size;
+    uint32_t      capacity;
+    uint32_t      head;         /* Next slot to read */
+    uint32_t      tail;         /* Next slot to write */
+    uint32_t      used;         /* Committed items + reserved slot */
+    uint8_t       reserved;     /* 1 while a queue_reserve() slot is not committed */
+    wait_queue_t  not_full;     /* Senders waiting for space */
+    wait_queue_t  not_empty;    /* Receivers waiting for an item */
+    queue_stats_t stats;
+    struct queue *next;         /* Registry of all queues */
+} queue_t;
+
+/* Snapshot of one queue for diagnostics */
+typedef struct queue_info {
+    const char   *name;
+    uint32_t      item_size;
+    uint32_t      capacity;
+    uint32_t      used;
+    queue_stats_t stats;
+} queue_info_t;
+
+
+/**
+ * @brief Initialize a queue and add it to the registry.
+ * 
+ * @param queue Queue to initialize; must stay allocated for the lifetime of the system
+ * @param name Name for diagnostics (not copied)
+ * @param storage Buffer of capacity * item_size bytes, aligned for the item type
+ * @param item_size Size of one item in bytes
+ * @param capacity Number of items
+ * @return QUEUE_OK or QUEUE_ERR_PARAM
+ */
+int32_t queue_init(queue_t *queue, const char *name, void *storage,
+                   uint32_t item_size, uint32_t capacity);
+
+
+/**
+ * @brief Copy an item to the back of the queue, blocking while it is full.
+ * 
+ * @param timeout_ticks SysTick ticks to wait, 0 to not wait, WAIT_FOREVER to block
+ * @return QUEUE_OK or a negative queue_status_t
+ */
+int32_t queue_send(queue_t *queue, const void *item, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Copy the front item out of the queue, blocking while it is empty.
+ * 
+ * @param timeout_ticks SysTick ticks to wait, 0 to not wait, WAIT_FOREVER to block
+ * @return QUEUE_OK or a negative queue_status_t
+ */
+int32_t queue_receive(queue_t *queue, void *item, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Non-blocking send for ISRs.
+ * 
+ * @return QUEUE_OK, or QUEUE_ERR_TIMEOUT if the queue is full
+ */
+int32_t queue_send_from_isr(queue_t *queue, const void *item);
+
+
+/**
+ * @brief Non-blocking receive for ISRs.
+ * 
+ * @return QUEUE_OK, or QUEUE_ERR_TIMEOUT if the queue is empty
+ */
+int32_t queue_receive_from_isr(queue_t *queue, void *item);
+
+
+/**
+ * @brief Reserve the next free slot for in-place writing.
+ * 
+ * Blocks like queue_send() while the queue is full or another reservation is
+ * outstanding. The slot is invisible to receivers until queue_commit().
+ * From an ISR only timeout_ticks = 0 is allowed.
+ * 
+ * @param timeout_ticks SysTick ticks to wait, 0 to not wait, WAIT_FOREVER to block
+ * @return Pointer to item_size bytes inside the queue storage, or NULL
+ */
+void *queue_reserve(queue_t *queue, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Publish the reserved slot to receivers.
+ * 
+ * @return QUEUE_OK or QUEUE_ERR_NO_RESERVATION
+ */
+int32_t queue_commit(queue_t *queue);
+
+
+/**
+ * @brief Give the reserved slot back without sending it.
+ * 
+ * @return QUEUE_OK or QUEUE_ERR_NO_RESERVATION
+ */
+int32_t queue_cancel(queue_t *queue);
+
+
+/**
+ * @brief Number of items ready to be received.
+ */
+uint32_t queue_count(const queue_t *queue);
+
+
+/**
+ * @brief Get a snapshot of the index-th registered queue.
+ * 
+ * @param index 0 .. number of queues - 1 (registration order, newest first)
+ * @param info Output
+ * @return 0 on success, -1 if index is past the end
+ */
+int32_t queue_get_info(uint32_t index, queue_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUEUE_H */
@@ -1,6 +1,15 @@
 #include "scheduler.h"
 #include "utils.h"
 #include "systick.h" 
+#include "dwt.h"
+#include "trace.h"
+#include "mutex.h"
+#if STACK_MPU_GUARD
+#include "mpu.h"
+#endif
+#if KERNEL_BENCH
+#include "bench.h"
+#endif
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
 #include "allocator.h"
 #endif
@@ -10,9 +19,80 @@ task_t  *task_current = NULL;
 task_t  *task_next = NULL;
 
 static uint32_t task_count = 0;
-static uint32_t task_current_index = 0;
-static uint16_t next_task_id = 0;
 static task_t *idle_task = NULL;
+static task_t *reap_list = NULL;   /* Zombies waiting for their slot to be released, via wait_next */
+
+#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
+/* task_create() stacks; task_create_static() tasks bring their own and take none */
+typedef struct {
+    uint32_t words[STACK_SIZE_IN_WORDS];
+} __attribute__((aligned(8))) task_stack_t;
+
+static task_stack_t task_stack_pool[TASK_STATIC_STACKS];
+static uint8_t task_stack_used[TASK_STATIC_STACKS];
+#endif
+
+/*
+ * One FIFO of READY tasks per priority level; bit p of ready_bitmap set while
+ * level p is not empty. Only touched with BASEPRI at MAX_SYSCALL_BASEPRI:
+ * task code and ISRs take the critical section, PendSV raises BASEPRI around
+ * schedule_next_task() (context_switch.S).
+ */
+static task_t *ready_head[TASK_PRIORITY_LEVELS];
+static task_t *ready_tail[TASK_PRIORITY_LEVELS];
+static uint32_t ready_bitmap = 0;
+
+#if SCHEDULER_EDF
+static uint32_t edf_density_total = 0;  /* Admitted EDF density, 1/65536 units */
+#endif
+
+#if STACK_MPU_GUARD
+/* Dynamic stacks are over-allocated so an aligned guard always fits below the usable area */
+#define STACK_GUARD_RESERVE     (2u * STACK_GUARD_SIZE)
+
+static stack_fault_info_t stack_fault_last;
+#else
+#define STACK_GUARD_RESERVE     0u
+#endif
+
+#if CONTEXT_SWITCH_PROFILING
+/* Written by PendSV_Handler (context_switch.S) */
+volatile uint32_t pendsv_entry_cycles = 0;
+volatile uint32_t pendsv_last_cycles = 0;
+
+static cycle_stats_t switch_stats_integer;
+static cycle_stats_t switch_stats_fpu;
+static uint8_t last_switch_fpu = 0;     /* Frame class of the switch being timed */
+static uint8_t last_switch_valid = 0;   /* First switch has no entry stamp yet */
+#endif
+
+#if KERNEL_BENCH
+static uint32_t last_schedule_cycles = 0; /* schedule_next_task share of the last switch */
+#endif
+
+#if SCHEDULER_CPU_STATS
+static uint32_t cpu_last_switch_cycles = 0; /* Timestamp of the previous accounting point */
+static uint32_t cpu_run_start_cycles = 0;   /* When task_current got the CPU */
+static uint32_t cpu_slice_start_cycles = 0;
+static uint32_t cpu_slice_ticks = 0;        /* Ticks into the current slice */
+static uint32_t cpu_slice_index = 0;        /* Slice the current one will replace */
+static uint32_t cpu_slice_cycles[CPU_STATS_WINDOW_SLICES];
+static cpu_window_stats_t cpu_window_last;  /* Sums over the complete slices */
+#endif
+
+#if SCHEDULER_LOAD_STATS
+/* exp(-100 ms / T) in 1/65536, for T = 1 s, 10 s and 60 s */
+#define LOAD_DECAY_1S           59299U
+#define LOAD_DECAY_10S          64883U
+#define LOAD_DECAY_60S          65427U
+
+static uint32_t load_avg[3];            /* 1 s, 10 s, 60 s in LOAD_FIXED_ONE units */
+static uint32_t load_period_sum = 0;    /* Runnable tasks summed over the current period */
+static uint32_t load_period_ticks = 0;
+static uint64_t ready_sum = 0;          /* Waiting tasks summed per tick */
+static uint32_t ready_ticks = 0;
+static uint32_t ready_max = 0;
+#endif
 
 void task_create_first(void); /* Forward declaration of the assembly entry */
 
@@ -20,13 +100,7 @@ void task_create_first(void); /* Forward declaration of the assembly entry */
 /* Idle task function */
 static void task_idle_function(void *arg) {
     (void)arg; /* Unused parameter */
-    static uint32_t last_gc_tick = 0;
     while(1) {
-        /* Run garbage collection */
-        if ((systick_ticks - last_gc_tick) >= GARBAGE_COLLECTION_TICKS) {
-            task_garbage_collection();
-            last_gc_tick = systick_ticks;
-        }
         __WFI(); /* Wait For Interrupt */
     }
 }
@@ -39,18 +113,20 @@ static uint32_t *initialize_stack(uint32_t *top_of_stack,
 {
     /* Push initial stack frame as expected by the hardware on exception return */
     *(top_of_stack--)   = 0x01000000u;          /* xPSR: Thumb bit set */
-    *(top_of_stack--)   = (uint32_t)task_func;  /* PC entry point */
-    *(top_of_stack--)   = (uint32_t)task_exit;  /* LR: task exit handler */
+    *(top_of_stack--)   = (uint32_t)(uintptr_t)task_func;  /* PC entry point */
+    *(top_of_stack--)   = (uint32_t)(uintptr_t)task_exit;  /* LR: task exit handler */
     *(top_of_stack--)   = 0x0u;                 /* R12 */
     *(top_of_stack--)   = 0x0u;                 /* R3 */
     *(top_of_stack--)   = 0x0u;                 /* R2 */
     *(top_of_stack--)   = 0x0u;                 /* R1 */
-    *(top_of_stack--)   = (uint32_t)arg;        /* R0 */
+    *(top_of_stack--)   = (uint32_t)(uintptr_t)arg; /* R0 */
 
     /* 
-     * Software Context (pushes 8 words: R4-R11) 
-     * These are expected by PendSV_Handler LDMIA instruction 
+     * Software Context (pushes 9 words: R4-R11 + EXC_RETURN) 
+     * These are expected by PendSV_Handler LDMIA instruction.
+     * A new task starts with a basic (non-FPU) frame.
      */
+    *(top_of_stack--)   = EXC_RETURN_THREAD_PSP; /* EXC_RETURN */
     *(top_of_stack--)   = 0;                    /* R11 */
     *(top_of_stack--)   = 0;                    /* R10 */
     *(top_of_stack--)   = 0;                    /* R9 */
@@ -64,28 +140,270 @@ static uint32_t *initialize_stack(uint32_t *top_of_stack,
 }
 
 
+/*
+ * Usable stack of a task: the whole stack memory, minus the MPU guard region
+ * and the padding below it. bottom[0] holds the canary. NULL once released.
+ */
+static uint32_t *task_stack_bottom(const task_t *task, uint32_t *size_bytes) {
+    uint32_t *mem = task->stack_ptr;
+    uint32_t size = task->stack_size;
+
+#if STACK_MPU_GUARD
+    if (mem != NULL) {
+        uint32_t *bottom = (uint32_t *)(uintptr_t)(task->stack_guard + STACK_GUARD_SIZE);
+        size -= (uint32_t)((uintptr_t)bottom - (uintptr_t)mem);
+        mem = bottom;
+    }
+#endif
+
+    *size_bytes = size;
+    return mem;
+}
+
+
+/* Initial stack pointer: last word of the stack, 8-byte aligned */
+static uint32_t *task_stack_top(uint32_t *bottom, uint32_t size_bytes) {
+    uintptr_t stack_addr = (uintptr_t)bottom + size_bytes - sizeof(uint32_t);
+    stack_addr &= ~(uintptr_t)0x7u;
+    return (uint32_t *)stack_addr;
+}
+
+
+#if STACK_WATERMARK
+/* Fill the stack with the watermark pattern, leaving the canary word at the bottom */
+static void stack_paint(uint32_t *stack_base, uint32_t size_bytes) {
+    uint32_t words = size_bytes / sizeof(uint32_t);
+
+    for (uint32_t i = 1; i < words; i++) {
+        stack_base[i] = STACK_PAINT_PATTERN;
+    }
+}
+#endif
+
+
 /* Create the idle task */
 static void task_create_idle(void) {
     if (idle_task != NULL) {
         return; 
     }
 
-    int32_t task_id = task_create(task_idle_function, NULL, STACK_SIZE_512B);
+    int32_t handle = task_create(task_idle_function, NULL, STACK_SIZE_512B);
 
-    if (task_id < 0) {
+    if (handle < 0) {
         /* Failed to create idle task - this is a critical error */
         return;
     }
 
-    /* find the idle task i just created */
-    for (uint32_t i = 0; i < task_count; ++i) {
-        if(task_list[i].task_id == task_id) {
-            idle_task = &task_list[i];
-            idle_task->is_idle = 1;
-            return;
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    idle_task = task_from_handle((task_handle_t)handle);
+    if (idle_task != NULL) {
+        idle_task->is_idle = 1;
+        task_set_effective_priority(idle_task, TASK_PRIORITY_IDLE);
+        idle_task->base_priority = TASK_PRIORITY_IDLE;
+    }
+    exit_critical_basepri(stat);
+}
+
+
+#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
+/* Take a free pool stack, NULL if all are in use. Caller holds the critical section. */
+static uint32_t *task_stack_claim(void) {
+    for (uint32_t i = 0; i < TASK_STATIC_STACKS; i++) {
+        if (!task_stack_used[i]) {
+            task_stack_used[i] = 1;
+            return task_stack_pool[i].words;
         }
     }
-    
+    return NULL;
+}
+#endif
+
+
+/* Return a slot to TASK_UNUSED, keeping its generation so old handles stay stale */
+static void task_release_slot(task_t *task) {
+    if (task->stack_ptr != NULL && !task->stack_external) {
+#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
+        allocator_free(task->stack_ptr);
+#else
+        task_stack_used[(task_stack_t *)task->stack_ptr - task_stack_pool] = 0;
+#endif
+    }
+    task->stack_ptr = NULL;
+    task->stack_size = 0;
+    task->stack_external = 0;
+#if STACK_MPU_GUARD
+    task->stack_guard = 0;
+#endif
+    task->psp = NULL;
+    task->sleep_until_tick = 0;
+    task->is_idle = 0;
+    task->handle = TASK_HANDLE_INVALID;
+    task->waiting_on = NULL;
+    task->wait_next = NULL;
+    task->mutex_held = NULL;
+    task->mutex_blocked_on = NULL;
+    task_set_state(task, TASK_UNUSED);
+}
+
+
+/* Queue a zombie for task_reap(). Caller holds the critical section. */
+static void task_reap_enqueue(task_t *task) {
+    task->wait_next = reap_list;
+    reap_list = task;
+}
+
+
+/* Release queued zombies; the running one stays queued until it has switched out.
+ * Caller holds the critical section. */
+static void task_reap(void) {
+    task_t **link = &reap_list;
+    while (*link != NULL) {
+        task_t *task = *link;
+
+        if (task == task_current) {
+            link = &task->wait_next;
+            continue;
+        }
+
+        *link = task->wait_next;
+        task_release_slot(task);
+    }
+
+    /* Only the tail shrinks; holes are reused by task_create(). Run order lives
+     * in the ready queues, so freeing slots does not disturb it. */
+    while (task_count > 0 && task_list[task_count - 1].state == TASK_UNUSED) {
+        task_count--;
+    }
+}
+
+
+/* End a task: hand its exit code to the joiners and queue it for reaping.
+ * Caller holds the critical section and has unlinked the task from any wait queue. */
+static void task_finish(task_t *task, int32_t exit_code) {
+    task->exit_code = exit_code;
+
+    /* Nothing may stay owned by, or boosted for, a slot about to be reused */
+    mutex_task_gone(task);
+
+    while (task->joiners.head != NULL) {
+        task_t *joiner = task->joiners.head;
+        joiner->join_code = exit_code;
+        wait_queue_wake_task(joiner, WAIT_OK);
+    }
+
+#if SCHEDULER_EDF
+    /* Give the admitted bandwidth back */
+    if (task->edf.enabled) {
+        edf_density_total -= task->edf.density;
+        task->edf.enabled = 0;
+    }
+#endif
+
+    task_set_state(task, TASK_ZOMBIE);
+    task->handle = TASK_HANDLE_INVALID;
+    task->exit_callback = NULL;
+    task_reap_enqueue(task);
+}
+
+
+/* Append to the back of the task's level. Caller holds the critical section. */
+static void ready_push(task_t *task) {
+    uint8_t level = task->priority;
+
+    task->ready_next = NULL;
+    task->ready_prev = ready_tail[level];
+    if (ready_tail[level] != NULL) {
+        ready_tail[level]->ready_next = task;
+    } else {
+        ready_head[level] = task;
+        ready_bitmap |= (1u << level);
+    }
+    ready_tail[level] = task;
+}
+
+
+/* Unlink from the task's level. Caller holds the critical section. */
+static void ready_remove(task_t *task) {
+    uint8_t level = task->priority;
+
+    if (task->ready_prev != NULL) {
+        task->ready_prev->ready_next = task->ready_next;
+    } else {
+        ready_head[level] = task->ready_next;
+    }
+    if (task->ready_next != NULL) {
+        task->ready_next->ready_prev = task->ready_prev;
+    } else {
+        ready_tail[level] = task->ready_prev;
+    }
+    if (ready_head[level] == NULL) {
+        ready_bitmap &= ~(1u << level);
+    }
+    task->ready_next = NULL;
+    task->ready_prev = NULL;
+}
+
+
+void task_set_state(task_t *task, uint8_t state) {
+    if (task->state == state) {
+        return;
+    }
+    if (task->state == TASK_READY) {
+        ready_remove(task);
+    }
+    task->state = state;
+    if (state == TASK_READY) {
+        ready_push(task);
+    }
+}
+
+
+/* Insert by priority, behind waiters of the same priority (FIFO) */
+static void wait_queue_insert(wait_queue_t *queue, task_t *task) {
+    task_t **link = &queue->head;
+
+    while (*link != NULL && (*link)->priority >= task->priority) {
+        link = &(*link)->wait_next;
+    }
+    task->wait_next = *link;
+    *link = task;
+    task->waiting_on = queue;
+}
+
+
+/* Unlink a task from the queue it waits on, if any */
+static void wait_queue_remove(task_t *task) {
+    wait_queue_t *queue = task->waiting_on;
+    if (queue == NULL) {
+        return;
+    }
+
+    for (task_t **link = &queue->head; *link != NULL; link = &(*link)->wait_next) {
+        if (*link == task) {
+            *link = task->wait_next;
+            break;
+        }
+    }
+    task->wait_next = NULL;
+    task->waiting_on = NULL;
+}
+
+
+/* End a wait: off the queue, timeout disarmed, READY with the given result */
+static void task_wake_waiter(task_t *task, int32_t result) {
+    wait_queue_remove(task);
+    task->sleep_until_tick = 0;
+    task->wait_result = (int8_t)result;
+    task_set_state(task, TASK_READY);
+    TRACE(TRACE_WAKE, task, result);
+}
+
+
+/* Ask for a switch if a task that just became ready outranks the running one */
+static void task_preempt_check(const task_t *task) {
+    if (task_current != NULL && task->priority > task_current->priority) {
+        yield_cpu();
+    }
 }
 
 
@@ -95,17 +413,123 @@ void scheduler_init(void) {
     task_current = NULL;
     task_next = NULL;
     task_count = 0;
-    task_current_index = 0;
-    next_task_id = 0;
     idle_task = NULL;
+    reap_list = NULL;
+#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
+    memset(task_stack_used, 0, sizeof(task_stack_used));
+#endif
+    memset(ready_head, 0, sizeof(ready_head));
+    memset(ready_tail, 0, sizeof(ready_tail));
+    ready_bitmap = 0;
+#if SCHEDULER_EDF
+    edf_density_total = 0;
+#endif
+}
+
+
+#if STACK_MPU_GUARD
+/* MPU regions must be aligned to their size: first aligned block of the stack memory */
+static uintptr_t stack_guard_base(const uint32_t *stack_mem) {
+    return ((uintptr_t)stack_mem + STACK_GUARD_SIZE - 1u) & ~(uintptr_t)(STACK_GUARD_SIZE - 1u);
+}
+#endif
+
+
+/* Find a free slot, reusing holes before growing the list. Caller holds the critical section. */
+static task_t *task_claim_slot(uint32_t *index_out) {
+    uint32_t index = task_count;
+
+    for (uint32_t i = 0; i < task_count; ++i) {
+        if (task_list[i].state == TASK_UNUSED) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index >= MAX_TASKS) {
+        return NULL;
+    }
+
+    *index_out = index;
+    return &task_list[index];
+}
+
+
+/*
+ * Build the initial frame on the slot's stack (stack_ptr/stack_size already
+ * set) and publish the task. Caller holds the critical section.
+ */
+static int32_t task_init_slot(task_t *new_task, uint32_t index, void (*task_func)(void *), void *arg) {
+#if STACK_MPU_GUARD
+    new_task->stack_guard = stack_guard_base(new_task->stack_ptr);
+#endif
+
+    uint32_t stack_bytes = 0;
+    uint32_t *stack_base = task_stack_bottom(new_task, &stack_bytes);
+    uint32_t *stack_end = task_stack_top(stack_base, stack_bytes);
+
+#if STACK_WATERMARK
+    /* Paint before the initial frame is written on top */
+    stack_paint(stack_base, stack_bytes);
+#endif
+
+    /* Initialize task */
+    new_task->psp = initialize_stack(stack_end, task_func, arg);
+#if STACK_PROFILE
+    new_task->entry = (uintptr_t)task_func;
+#endif
+    new_task->is_idle = 0;
+    new_task->sleep_until_tick = 0;
+    new_task->priority = TASK_PRIORITY_DEFAULT;
+    new_task->base_priority = TASK_PRIORITY_DEFAULT;
+    new_task->wait_result = WAIT_OK;
+    new_task->waiting_on = NULL;
+    new_task->wait_next = NULL;
+    new_task->mutex_held = NULL;
+    new_task->mutex_blocked_on = NULL;
+    new_task->notify_state = NOTIFY_STATE_NONE;
+    new_task->notify_value = 0;
+    new_task->exit_code = TASK_EXIT_OK;
+    new_task->join_code = TASK_EXIT_OK;
+    wait_queue_init(&new_task->joiners);
+    new_task->exit_callback = NULL;
+    new_task->exit_callback_arg = NULL;
+#if SCHEDULER_EDF
+    memset(&new_task->edf, 0, sizeof(new_task->edf));
+#endif
+#if SCHEDULER_CPU_STATS
+    new_task->run_cycles = 0;
+    memset(new_task->run_cycles_slice, 0, sizeof(new_task->run_cycles_slice));
+    new_task->run_cycles_last = 0;
+    new_task->max_run_cycles = 0;
+    new_task->switch_count = 0;
+#endif
+
+    /* New generation for this slot; 0 is reserved so a handle is never 0 */
+    new_task->generation++;
+    if (new_task->generation == 0) {
+        new_task->generation = 1;
+    }
+    new_task->handle = TASK_HANDLE_MAKE(index, new_task->generation);
+
+    if (index == task_count) {
+        task_count++;
+    }
+
+    /* Behind the tasks already waiting at its level */
+    task_set_state(new_task, TASK_READY);
+
+    /* Set stack canary at the bottom for overflow detection */
+    stack_base[0] = STACK_CANARY;
 
+    return (int32_t)new_task->handle;
 }
 
 
 /* Create a new task */
 int32_t task_create(void (*task_func)(void *), void *arg, size_t stack_size_bytes)
 {
-    if (task_count >= MAX_TASKS || task_func == NULL) {
+    if (task_func == NULL) {
         return -1;
     }
 
@@ -125,61 +549,80 @@ int32_t task_create(void (*task_func)(void *), void *arg, size_t stack_size_byte
     stack_size_bytes = STACK_SIZE_BYTES;
 #endif
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
-
-    /* Find unused task slot */
-    uint32_t unused_task_index = task_count;
-    task_t *new_task = &task_list[task_count];
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
 
-    for (uint32_t i = 0; i < task_count; ++i) {
-        if (task_list[i].state == TASK_UNUSED) {
-            new_task = &task_list[i];
-            unused_task_index = i;
-            break;
-        }
+    uint32_t index;
+    task_t *new_task = task_claim_slot(&index);
+    if (new_task == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
     }
 
-    uint32_t *stack_end = NULL;
-    uint32_t *stack_base = NULL;
-
 #if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
-    /* Static allocation: use embedded stack */
-    stack_base = new_task->stack;
-    stack_end = &new_task->stack[STACK_SIZE_IN_WORDS - 1];
+    /* Static allocation: take a stack from the pool */
+    uint32_t *stack_mem = task_stack_claim();
+    if (stack_mem == NULL) {
+        exit_critical_basepri(stat);
+        return -1;  /* Pool exhausted */
+    }
+    new_task->stack_ptr = stack_mem;
+    new_task->stack_size = STACK_SIZE_BYTES;
 #else
-    /* Dynamic allocation: allocate stack from heap */
-    stack_base = (uint32_t*)allocator_malloc(stack_size_bytes);
-    if (stack_base == NULL) {
+    /* Dynamic allocation: allocate stack (plus room for the guard) from heap */
+    uint32_t *stack_mem = (uint32_t*)allocator_malloc(stack_size_bytes + STACK_GUARD_RESERVE);
+    if (stack_mem == NULL) {
         exit_critical_basepri(stat);
         return -1;  /* Allocation failed */
     }
-    new_task->stack_ptr = stack_base;
-    new_task->stack_size = stack_size_bytes;
-    stack_end = (uint32_t*)((uint8_t*)stack_base + stack_size_bytes - sizeof(uint32_t));
+    new_task->stack_ptr = stack_mem;
+    new_task->stack_size = stack_size_bytes + STACK_GUARD_RESERVE;
 #endif
+    new_task->stack_external = 0;
 
-    /* Enforce 8-byte alignment on stack top */
-    uint32_t stack_addr = (uint32_t)stack_end;
-    stack_addr &= ~0x7u;
-    stack_end = (uint32_t *)stack_addr;
+    int32_t handle = task_init_slot(new_task, index, task_func, arg);
 
-    /* Initialize task */
-    new_task->psp = initialize_stack(stack_end, task_func, arg);
-    new_task->state = TASK_READY;
-    new_task->is_idle = 0;
-    new_task->task_id = ++next_task_id;
-    new_task->sleep_until_tick = 0;
+    exit_critical_basepri(stat);
 
-    if (unused_task_index == task_count) {
-        task_count++;
+    return handle;
+}
+
+
+/* Create a task on a caller-provided stack */
+int32_t task_create_static(void (*task_func)(void *), void *arg, uint32_t *stack, size_t stack_size_bytes)
+{
+    if (task_func == NULL || stack == NULL || ((uintptr_t)stack & 0x7u) != 0) {
+        return -1;
     }
 
-    /* Set stack canary at the bottom for overflow detection */
-    stack_base[0] = STACK_CANARY;
+    stack_size_bytes &= ~(size_t)0x7u;
+
+    /* What is left above the guard must still make a minimal stack */
+    size_t overhead = 0;
+#if STACK_MPU_GUARD
+    overhead = (size_t)(stack_guard_base(stack) + STACK_GUARD_SIZE - (uintptr_t)stack);
+#endif
+    if (stack_size_bytes < overhead + STACK_MIN_SIZE_BYTES) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    uint32_t index;
+    task_t *new_task = task_claim_slot(&index);
+    if (new_task == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    new_task->stack_ptr = stack;
+    new_task->stack_size = (uint32_t)stack_size_bytes;
+    new_task->stack_external = 1;
+
+    int32_t handle = task_init_slot(new_task, index, task_func, arg);
 
     exit_critical_basepri(stat);
 
-    return new_task->task_id;
+    return handle;
 }
 
 
@@ -191,130 +634,425 @@ void scheduler_start(void) {
 
     task_create_idle();
 
-    task_current_index = 0;
     task_current = &task_list[0];
     task_next = &task_list[0];
-    task_current->state = TASK_RUNNING;
+    task_set_state(task_current, TASK_RUNNING);
+
+#if SCHEDULER_CPU_STATS
+    cpu_last_switch_cycles = dwt_get_cycles();
+    cpu_run_start_cycles = cpu_last_switch_cycles;
+    cpu_slice_start_cycles = cpu_last_switch_cycles;
+    cpu_slice_ticks = 0;
+    cpu_slice_index = 0;
+    memset(cpu_slice_cycles, 0, sizeof(cpu_slice_cycles));
+    memset(&cpu_window_last, 0, sizeof(cpu_window_last));
+    task_current->switch_count = 1;
+#endif
+
+#if STACK_MPU_GUARD
+    mpu_stack_guard_init((uint32_t)task_current->stack_guard);
+#endif
+
     task_create_first(); /* Assembly function to start the first task */
 }
 
 
-/* Called by PendSV to pick next task */ 
-void schedule_next_task(void) {
-    if (task_count == 0) {
-        return;
+#if CONTEXT_SWITCH_PROFILING
+/* A task has live FPU state if its saved EXC_RETURN has FType (bit 4) clear */
+static uint8_t task_has_fpu_frame(const task_t *task) {
+    if (task == NULL || task->psp == NULL) {
+        return 0;
     }
+    return (task->psp[TASK_FRAME_EXC_RETURN_WORD] & EXC_RETURN_FTYPE_MASK) == 0;
+}
 
-    if (task_current == NULL) {
-        task_current_index = 0;
-        task_current = &task_list[0];
-        task_current->state = TASK_RUNNING;
-        task_next = task_current;
-        return;
-    }
-    
-    uint32_t next = (task_current_index + 1) % task_count;
-    if (task_current && task_current->state == TASK_RUNNING) {
-        task_current->state = TASK_READY;
-    }
 
-    /* Simple round-robin: find next READY task that is not sleeping */
-    for (uint32_t i = 0; i < task_count; ++i) {
-        if(task_list[next].state == TASK_READY &&
-           task_list[next].is_idle == 0 &&
-           task_list[next].sleep_until_tick == 0) {  /* Not sleeping */
-
-            task_current_index = next;
-            task_next = &task_list[next];
-            task_next->state = TASK_RUNNING;
-            return;
-        }
-        next = (next + 1) % task_count;
+/* 
+ * Account the previous switch. PendSV stamps its duration only after
+ * schedule_next_task returned, so it is folded in on the following switch.
+ */
+static void switch_stats_update(void) {
+    if (last_switch_valid) {
+        cycle_stats_add(last_switch_fpu ? &switch_stats_fpu : &switch_stats_integer,
+                        pendsv_last_cycles);
+#if KERNEL_BENCH
+        /* What is left once the C part is taken out is the register save/restore */
+        bench_record(BENCH_PENDSV_SAVE_RESTORE, pendsv_last_cycles - last_schedule_cycles);
+#endif
     }
+}
 
-    /* If no READY task found, schedule idle task */
-    if (idle_task != NULL && idle_task->state == TASK_READY) {
-        task_next = idle_task;
-        task_next->state = TASK_RUNNING;
 
-        for (uint32_t i = 0; i < task_count; i++) {
-            if (&task_list[i] == idle_task) {
-                task_current_index = i;
-                break;
-            }
-        }
-        return;
+/* Copy the context switch cycle statistics */
+void scheduler_get_switch_stats(cycle_stats_t *integer, cycle_stats_t *fpu) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    if (integer != NULL) {
+        *integer = switch_stats_integer;
     }
-
-    /* Fallback: if all tasks are non-READY, just stay */
-    task_next = &task_list[task_current_index];
-    task_next->state = TASK_RUNNING;
+    if (fpu != NULL) {
+        *fpu = switch_stats_fpu;
+    }
+    exit_critical_basepri(stat);
 }
+#endif
 
 
-/* Block a task */
-void task_block(task_t *task) {
-    if (task == NULL) {
-        return;
-    }
+#if SCHEDULER_CPU_STATS
+/* Charge the cycles since the last switch to the outgoing task */
+static void cpu_stats_charge(uint32_t now) {
+    task_current->run_cycles += now - cpu_last_switch_cycles;
+    cpu_last_switch_cycles = now;
+}
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
 
-    if (task->state != TASK_UNUSED && !task->is_idle) {
-        task->state = TASK_BLOCKED;
+/*
+ * From the wake scan: 1 if this tick ends a slice. The running task is then
+ * charged up to now, so its slice is complete too. PendSV cannot preempt
+ * SysTick, so the counters are not touched underneath us.
+ */
+static uint8_t cpu_stats_slice_due(void) {
+    if (++cpu_slice_ticks < CPU_STATS_WINDOW_TICKS / CPU_STATS_WINDOW_SLICES ||
+        task_current == NULL) {
+        return 0;
     }
+    cpu_slice_ticks = 0;
+    cpu_stats_charge(dwt_get_cycles());
+    return 1;
+}
 
-    exit_critical_basepri(stat);
+
+/* Replace the task's oldest slice with the one just ended */
+static void cpu_stats_roll_task(task_t *task) {
+    uint32_t *oldest = &task->run_cycles_slice[cpu_slice_index];
+    task->run_cycles_last += task->run_cycles - *oldest;
+    *oldest = task->run_cycles;
+    task->run_cycles = 0;
 }
 
 
-/* Unblock a task */
-void task_unblock(task_t *task) {
-    if (task == NULL) {
-        return;
+/* Same for the window length, once every task has rolled */
+static void cpu_stats_roll_window(void) {
+    uint32_t now = cpu_last_switch_cycles;  /* Set by cpu_stats_slice_due() */
+    uint32_t *oldest = &cpu_slice_cycles[cpu_slice_index];
+
+    cpu_window_last.window_cycles += (now - cpu_slice_start_cycles) - *oldest;
+    *oldest = now - cpu_slice_start_cycles;
+    cpu_window_last.idle_cycles = (idle_task != NULL) ? idle_task->run_cycles_last : 0;
+    cpu_slice_start_cycles = now;
+
+    if (++cpu_slice_index == CPU_STATS_WINDOW_SLICES) {
+        cpu_slice_index = 0;
     }
+}
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
 
-    if (task->state == TASK_BLOCKED) {
-        task->state = TASK_READY;
+/* Close the outgoing task's run if the CPU actually changes hands */
+static void cpu_stats_switch(uint32_t now) {
+    if (task_next == task_current) {
+        return; /* Same task continues, its run keeps growing */
     }
 
-    exit_critical_basepri(stat);
+    uint32_t ran = now - cpu_run_start_cycles;
+    if (ran > task_current->max_run_cycles) {
+        task_current->max_run_cycles = ran;
+    }
+    cpu_run_start_cycles = now;
+    task_next->switch_count++;
 }
 
 
-/* Block the current task */
-void task_block_current(void) {
-    if (task_current == NULL) {
+/* Copy the last complete window */
+void scheduler_get_cpu_window(cpu_window_stats_t *stats) {
+    if (stats == NULL) {
         return;
     }
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    *stats = cpu_window_last;
+    exit_critical_basepri(stat);
+}
+#endif
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
 
-    if (task_current && task_current->state != TASK_UNUSED && !task_current->is_idle) {
-        task_current->state = TASK_BLOCKED;
-    }
+/* Wrap-safe "tick t has been reached at now" */
+static uint8_t tick_reached(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) >= 0;
+}
 
-    exit_critical_basepri(stat);
 
-    yield_cpu();
+/* sleep_until_tick value for tick t: 0 means "not sleeping", so nudge a tick that wrapped onto it */
+static uint32_t wake_tick(uint32_t t) {
+    return (t == 0) ? 1u : t;
 }
 
 
-/* Delete a task */
-int32_t task_delete(uint16_t task_id) {
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+#if SCHEDULER_EDF
 
-    task_t *task_to_delete = NULL;
+/* Tie-break within a priority level: EDF tasks first, earliest deadline first */
+static uint8_t edf_before(const task_t *a, const task_t *b) {
+    if (!a->edf.enabled) {
+        return 0;
+    }
+    if (!b->edf.enabled) {
+        return 1;
+    }
+    return (int32_t)(a->edf.deadline - b->edf.deadline) < 0;
+}
+#endif
 
-    for (uint32_t i = 0; i < task_count; ++i) {
-        if (task_list[i].task_id == task_id) {
-            task_to_delete = &task_list[i];
-            break;
+
+/*
+ * Pick the next task: the head of the highest non-empty ready queue. The
+ * outgoing task re-enters its queue at the back, so n tasks sharing a level
+ * each run within n switches of becoming ready, whatever their slots are.
+ */
+static void scheduler_select_next(void) {
+    if (task_count == 0) {
+        return;
+    }
+
+    if (task_current == NULL) {
+        task_current = &task_list[0];
+        task_set_state(task_current, TASK_RUNNING);
+        task_next = task_current;
+        return;
+    }
+
+    if (task_current->state == TASK_RUNNING) {
+        task_set_state(task_current, TASK_READY);
+    }
+
+    if (ready_bitmap != 0) {
+        uint32_t level = 31u - (uint32_t)__builtin_clz(ready_bitmap);
+        task_t *best = ready_head[level];
+
+#if SCHEDULER_EDF
+        /* EDF tasks share their level by deadline instead, ahead of plain tasks */
+        if (edf_density_total != 0) {
+            for (task_t *task = best->ready_next; task != NULL; task = task->ready_next) {
+                if (edf_before(task, best)) {
+                    best = task;
+                }
+            }
+        }
+#endif
+
+        task_next = best;
+        task_set_state(task_next, TASK_RUNNING);
+        return;
+    }
+
+    /* Nothing ready, not even idle: stay on the current task, which is not revived if blocked or dead */
+    task_next = task_current;
+}
+
+
+/* Called by PendSV to pick next task, with BASEPRI already at MAX_SYSCALL_BASEPRI */
+void schedule_next_task(void) {
+#if KERNEL_BENCH
+    uint32_t bench_start = dwt_get_cycles();
+#endif
+
+#if CONTEXT_SWITCH_PROFILING
+    /* PendSV saved S16-S31 for the outgoing task if its EXC_RETURN said so */
+    uint8_t outgoing_fpu = task_has_fpu_frame(task_current);
+    switch_stats_update();
+#endif
+
+#if SCHEDULER_CPU_STATS
+    uint32_t now = dwt_get_cycles();
+    if (task_current != NULL) {
+        cpu_stats_charge(now);
+    }
+#endif
+
+    scheduler_select_next();
+
+    /* Zombies other than the outgoing task are off the CPU for good */
+    if (reap_list != NULL) {
+        task_reap();
+    }
+
+    if (task_next != task_current) {
+        TRACE(TRACE_SWITCH, task_next, trace_task_id(task_current));
+    }
+
+#if STACK_MPU_GUARD
+    /* Guard the incoming stack; PendSV's exception return makes it effective */
+    if (task_next != NULL) {
+        mpu_stack_guard_set((uint32_t)task_next->stack_guard);
+    }
+#endif
+
+#if SCHEDULER_CPU_STATS
+    if (task_current != NULL && task_next != NULL) {
+        cpu_stats_switch(now);
+    }
+#endif
+
+#if CONTEXT_SWITCH_PROFILING
+    /* ... and restores them for the incoming one on the way out */
+    last_switch_fpu = outgoing_fpu | task_has_fpu_frame(task_next);
+    last_switch_valid = (task_count != 0);
+#endif
+
+#if KERNEL_BENCH
+    last_schedule_cycles = dwt_get_cycles() - bench_start;
+    bench_record(BENCH_SCHEDULE_NEXT, last_schedule_cycles);
+#endif
+}
+
+
+/* Resolve a handle to its task: one index plus a generation compare */
+task_t *task_from_handle(task_handle_t handle) {
+    uint32_t index = TASK_HANDLE_INDEX(handle);
+
+    if (handle == TASK_HANDLE_INVALID || index >= MAX_TASKS) {
+        return NULL;
+    }
+
+    task_t *task = &task_list[index];
+
+    /* A zombie has already cleared its handle, so it never matches */
+    if (task->state == TASK_UNUSED || task->handle != handle) {
+        return NULL;
+    }
+
+    return task;
+}
+
+
+/* Handle of the running task */
+task_handle_t task_get_current_handle(void) {
+    if (task_current == NULL) {
+        return TASK_HANDLE_INVALID;
+    }
+    return task_current->handle;
+}
+
+
+/* Set the base priority; an inherited boost above it stays until unlock */
+int32_t task_set_priority(task_handle_t handle, uint8_t priority) {
+    if (priority < TASK_PRIORITY_MIN || priority > TASK_PRIORITY_MAX) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    if (task == NULL || task->is_idle) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+#if SCHEDULER_EDF
+    if (task->edf.enabled) {
+        exit_critical_basepri(stat);
+        return -1;  /* EDF tasks stay at EDF_TASK_PRIORITY */
+    }
+#endif
+
+    uint8_t boosted = (task->priority > task->base_priority);
+    task->base_priority = priority;
+    if (!boosted || priority > task->priority) {
+        task_set_effective_priority(task, priority);
+    }
+
+    /* A waiter's owner runs at its priority, up or down */
+    mutex_waiter_repropagate(task);
+
+    exit_critical_basepri(stat);
+
+    /* Let the scheduler re-evaluate: the task may now outrank us, or we may have dropped */
+    if (task_current != NULL) {
+        yield_cpu();
+    }
+
+    return 0;
+}
+
+
+/* Effective priority of a task */
+int32_t task_get_priority(task_handle_t handle) {
+    task_t *task = task_from_handle(handle);
+    if (task == NULL) {
+        return -1;
+    }
+    return task->priority;
+}
+
+
+/* Block a task */
+int32_t task_block(task_handle_t handle) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    if (task == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    if (!task->is_idle) {
+        task_set_state(task, TASK_BLOCKED);
+        TRACE(TRACE_BLOCK, task, 0);
+    }
+
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+
+
+/* Unblock a task */
+int32_t task_unblock(task_handle_t handle) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    if (task == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    if (task->state == TASK_BLOCKED) {
+        if (task->waiting_on != NULL) {
+            task_wake_waiter(task, WAIT_ABORTED);
+        } else {
+            task->sleep_until_tick = 0;     /* Cut a sleep short too */
+            task_set_state(task, TASK_READY);
         }
+        TRACE(TRACE_UNBLOCK, task, 0);
+        task_preempt_check(task);
+    }
+
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+
+
+/* Block the current task */
+void task_block_current(void) {
+    if (task_current == NULL) {
+        return;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (task_current && task_current->state != TASK_UNUSED && !task_current->is_idle) {
+        task_set_state(task_current, TASK_BLOCKED);
+        TRACE_CURRENT(TRACE_BLOCK, 0);
     }
 
+    exit_critical_basepri(stat);
+
+    yield_cpu();
+}
+
+
+/* Delete a task */
+int32_t task_delete(task_handle_t handle) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task_to_delete = task_from_handle(handle);
+
     if (task_to_delete == NULL) {
         exit_critical_basepri(stat);
         return TASK_DELETE_TASK_NOT_FOUND;
@@ -330,39 +1068,142 @@ int32_t task_delete(uint16_t task_id) {
         return TASK_DELETE_IS_CURRENT_TASK; 
     }
 
-    /* Mark task as zombie and free its stack in garbage collection */
-    task_to_delete->state = TASK_ZOMBIE;
-    task_to_delete->task_id = 0;
+    /* A blocked waiter must not stay linked into the queue it was waiting on */
+    wait_queue_remove(task_to_delete);
+
+    task_exit_callback_t callback = task_to_delete->exit_callback;
+    void *callback_arg = task_to_delete->exit_callback_arg;
+
+    /* Mark task as zombie and queue its slot and stack for reaping */
+    task_finish(task_to_delete, TASK_EXIT_DELETED);
 
     exit_critical_basepri(stat);
 
+    /* The victim cannot run it, so the caller does */
+    if (callback != NULL) {
+        callback(handle, TASK_EXIT_DELETED, callback_arg);
+    }
+
     return TASK_DELETE_SUCCESS;
 }
 
 
+#if STACK_WATERMARK
+int32_t task_get_stack_info(task_handle_t handle, task_stack_info_t *info) {
+    if (info == NULL) {
+        return -1;
+    }
+
+    /* Held for the scan so the stack cannot be released underneath it */
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    uint32_t *stack_base = NULL;
+    uint32_t size = 0;
+
+    if (task != NULL) {
+        stack_base = task_stack_bottom(task, &size);
+    }
+
+    if (stack_base == NULL || task->psp == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    /* Untouched words above the canary */
+    uint32_t words = size / sizeof(uint32_t);
+    uint32_t unused = 0;
+    while (unused + 1 < words && stack_base[unused + 1] == STACK_PAINT_PATTERN) {
+        unused++;
+    }
+
+    /* The caller's own PSP is live, not the one saved at the last switch */
+    uint32_t sp_probe = 0;
+    uintptr_t sp = (task == task_current) ? (uintptr_t)&sp_probe : (uintptr_t)task->psp;
+    uintptr_t top = (uintptr_t)stack_base + size;
+
+    info->size = size;
+    info->used = (uint32_t)(top - sp);
+    info->peak = size - (unused + 1) * sizeof(uint32_t);
+
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+#endif
+
+
+#if STACK_MPU_GUARD
+void scheduler_get_stack_fault(stack_fault_info_t *info) {
+    if (info == NULL) {
+        return;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    *info = stack_fault_last;
+    exit_critical_basepri(stat);
+}
+
+
+/* Where a task killed by its stack guard resumes, on a fresh frame */
+static void task_fault_exit(void *arg) {
+    (void)arg;
+    task_exit_with_code(TASK_EXIT_FAULT);
+}
+
+
+/* MemManage from a task: record it, then send the task to task_exit() on a clean stack */
+uint32_t scheduler_stack_fault(uint32_t exc_return) {
+    uint32_t address = 0;
+    uint32_t mmfsr = mpu_fault_take(&address);
+    task_t *task = task_current;
+
+    if (task != NULL) {
+        stack_fault_last.count++;
+        stack_fault_last.handle = task->handle;
+        stack_fault_last.address = address;
+        stack_fault_last.mmfsr = mmfsr;
+    }
+
+    /* A fault in a handler (including PendSV saving a nearly full stack) cannot be unwound */
+    if (task == NULL || task->is_idle ||
+        (exc_return & EXC_RETURN_THREAD_PSP_MASK) != EXC_RETURN_THREAD_PSP_MASK) {
+        return 0;
+    }
+
+    /* The task may have faulted inside a critical section */
+    exit_critical_basepri(0);
+
+    /* The stack contents are dead: rebuild an initial frame at the top and
+     * return straight into its hardware part */
+    uint32_t size = 0;
+    uint32_t *stack_end = task_stack_top(task_stack_bottom(task, &size), size);
+    uint32_t *frame = initialize_stack(stack_end, task_fault_exit, NULL);
+
+    return (uint32_t)(uintptr_t)(frame + TASK_FRAME_SW_WORDS);
+}
+#endif
+
+
 /* Check all tasks for stack overflow */
 void task_check_stack_overflow(void) {
     uint32_t current_task_overflow = 0;
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
 
     for (uint32_t i = 0; i < task_count; ++i) {
         if (task_list[i].state != TASK_UNUSED) {
-            uint32_t *stack_base = NULL;
-#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
-            stack_base = task_list[i].stack;
-#else
-            stack_base = task_list[i].stack_ptr;
-#endif
+            uint32_t size = 0;
+            uint32_t *stack_base = task_stack_bottom(&task_list[i], &size);
             
             if (stack_base != NULL && stack_base[0] != STACK_CANARY) {
                 if (&task_list[i] == task_current) {
                     current_task_overflow = 1;
                 } else {
-                    uint16_t id_to_delete = task_list[i].task_id;
+                    task_handle_t handle_to_delete = task_list[i].handle;
                     exit_critical_basepri(stat);
-                    task_delete(id_to_delete);
-                    stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+                    task_delete(handle_to_delete);
+                    stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
                 }
             }
         }
@@ -371,77 +1212,113 @@ void task_check_stack_overflow(void) {
     exit_critical_basepri(stat);
 
     if (current_task_overflow) {
-        task_exit();
+        task_exit_with_code(TASK_EXIT_FAULT);
     }
 }
  
 
 /* task voluntarily exits */
 void task_exit(void) {
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+    task_exit_with_code(TASK_EXIT_OK);
+}
+
+
+void task_exit_with_code(int32_t exit_code) {
+    /* The callback runs first, while the task is still alive and owns its stack */
+    if (task_current != NULL && task_current->exit_callback != NULL) {
+        task_current->exit_callback(task_current->handle, exit_code,
+                                    task_current->exit_callback_arg);
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
 
     if (task_current != NULL) {
-        task_current->state = TASK_ZOMBIE;
-        task_current->task_id = 0;
+        task_finish(task_current, exit_code);
     }
 
+    /* PendSV is taken as soon as BASEPRI drops and never selects a zombie */
+    yield_cpu();
     exit_critical_basepri(stat);
 
+    /* Only reached if the caller had interrupts masked */
     while(1) {
         yield_cpu();
     }
 }
 
 
-/* Rearrage active tasks and update their count */
 void task_garbage_collection(void) {
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
-    
-    uint32_t read_idx = 0;
-    uint32_t write_idx = 0;
-    
-    // Find first available slot
-    while (read_idx < task_count) {
-        if (task_list[read_idx].state == TASK_ZOMBIE) {
-#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_DYNAMIC
-            if (task_list[read_idx].stack_ptr != NULL) {
-                allocator_free(task_list[read_idx].stack_ptr);
-                task_list[read_idx].stack_ptr = NULL;
-            }
-            task_list[read_idx].state = TASK_UNUSED;
-#endif
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    task_reap();
+    exit_critical_basepri(stat);
+}
+
+
+int32_t task_join(task_handle_t handle, uint32_t timeout_ticks, int32_t *exit_code) {
+    uint32_t index = TASK_HANDLE_INDEX(handle);
+
+    if (handle == TASK_HANDLE_INVALID || index >= MAX_TASKS) {
+        return TASK_JOIN_ERR_NOT_FOUND;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *target = &task_list[index];
+    int32_t code;
+
+    if (target->handle == handle) {
+        /* Still alive: wait for task_finish() to hand over the code */
+        if (target == task_current) {
+            exit_critical_basepri(stat);
+            return TASK_JOIN_ERR_SELF;
         }
 
-        if (task_list[read_idx].state != TASK_UNUSED) {
-            // Found an active task. If it's not where it should be, move it.
-            if (read_idx != write_idx) {
-                task_list[write_idx] = task_list[read_idx];
-                
-                // Update pointers and indices if the current task was moved
-                if (&task_list[read_idx] == task_current) {
-                    task_current = &task_list[write_idx];
-                    task_current_index = write_idx;
-                }
+        if (timeout_ticks == 0) {
+            exit_critical_basepri(stat);
+            return TASK_JOIN_ERR_TIMEOUT;
+        }
 
-                if (&task_list[read_idx] == task_next) {
-                    task_next = &task_list[write_idx];
-                }
+        if (in_isr() || task_current == NULL) {
+            exit_critical_basepri(stat);
+            return TASK_JOIN_ERR_ISR;
+        }
 
-                if (idle_task == &task_list[read_idx]) {
-                    idle_task = &task_list[write_idx];
-                }
-            }
-            write_idx++;
+        int32_t result = task_wait(&target->joiners, timeout_ticks, stat);
+        if (result != WAIT_OK) {
+            return (result == WAIT_TIMEOUT) ? TASK_JOIN_ERR_TIMEOUT : TASK_JOIN_ERR_ABORTED;
         }
-        read_idx++;
+        code = task_current->join_code;
+    } else if (target->generation == TASK_HANDLE_GENERATION(handle) && target->generation != 0) {
+        /* Already gone, but the slot still holds its record */
+        code = target->exit_code;
+        exit_critical_basepri(stat);
+    } else {
+        exit_critical_basepri(stat);
+        return TASK_JOIN_ERR_NOT_FOUND;
+    }
+
+    if (exit_code != NULL) {
+        *exit_code = code;
+    }
+
+    return TASK_JOIN_OK;
+}
+
+
+int32_t task_set_exit_callback(task_handle_t handle, task_exit_callback_t callback, void *arg) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    if (task == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
     }
-    
-    task_count = write_idx;
 
-    // Clear the unused slots at the end
-    memset(&task_list[task_count], 0, (MAX_TASKS - task_count) * sizeof(task_t));
+    task->exit_callback = callback;
+    task->exit_callback_arg = arg;
 
     exit_critical_basepri(stat);
+    return 0;
 }
 
 
@@ -461,14 +1338,15 @@ int task_sleep_ticks(uint32_t ticks)
         return -1;
     }
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
 
     /* Set the wake-up time */
-    task_current->sleep_until_tick = systick_ticks + ticks;
+    task_current->sleep_until_tick = wake_tick(systick_ticks + ticks);
 
     /* Block the task */
     if (task_current->state != TASK_UNUSED && !task_current->is_idle) {
-        task_current->state = TASK_BLOCKED;
+        task_set_state(task_current, TASK_BLOCKED);
+        TRACE_CURRENT(TRACE_SLEEP, TRACE_ARG_SAT(ticks));
     }
 
     exit_critical_basepri(stat);
@@ -479,22 +1357,473 @@ int task_sleep_ticks(uint32_t ticks)
     return 0;
 }
 
+#if SCHEDULER_LOAD_STATS
+static uint32_t load_decay(uint32_t load, uint32_t decay, uint32_t sample) {
+    return (uint32_t)(((uint64_t)load * decay +
+                       (uint64_t)sample * (LOAD_FIXED_ONE - decay)) >> LOAD_FIXED_SHIFT);
+}
+
+
+/* Per-tick accounting; runnable counts the running task too */
+static void load_stats_tick(uint32_t runnable) {
+    uint32_t running = (task_current != NULL && !task_current->is_idle &&
+                        task_current->state == TASK_RUNNING) ? 1u : 0u;
+    uint32_t ready = (runnable > running) ? runnable - running : 0u;
+
+    if (ready > ready_max) {
+        ready_max = ready;
+    }
+    if (ready_ticks == UINT32_MAX) {
+        ready_sum >>= 1;    /* Keep the ratio, make room */
+        ready_ticks >>= 1;
+    }
+    ready_sum += ready;
+    ready_ticks++;
+
+    load_period_sum += runnable;
+    if (++load_period_ticks >= LOAD_SAMPLE_TICKS) {
+        uint32_t sample = (load_period_sum << LOAD_FIXED_SHIFT) / LOAD_SAMPLE_TICKS;
+        load_avg[0] = load_decay(load_avg[0], LOAD_DECAY_1S, sample);
+        load_avg[1] = load_decay(load_avg[1], LOAD_DECAY_10S, sample);
+        load_avg[2] = load_decay(load_avg[2], LOAD_DECAY_60S, sample);
+        load_period_sum = 0;
+        load_period_ticks = 0;
+    }
+}
+
+
+void scheduler_get_load_stats(load_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    stats->load_1s = load_avg[0];
+    stats->load_10s = load_avg[1];
+    stats->load_60s = load_avg[2];
+    stats->ready_max = ready_max;
+    uint64_t sum = ready_sum << LOAD_FIXED_SHIFT;
+    uint32_t ticks = ready_ticks;
+    exit_critical_basepri(stat);
+
+    stats->ready_avg = u64_div_u32(sum, ticks);
+}
+#endif
+
+
 /**
  * @brief Wake up any sleeping tasks whose wake-up time has arrived.
  * Called by SysTick_Handler in systick.c.
  */
 void scheduler_wake_sleeping_tasks(void)
 {
+#if KERNEL_BENCH
+    uint32_t bench_start = dwt_get_cycles();
+#endif
+
+#if SCHEDULER_LOAD_STATS
+    uint32_t runnable = 0;
+#endif
+#if SCHEDULER_CPU_STATS
+    uint8_t cpu_roll = cpu_stats_slice_due();
+#endif
+
     /* Check all tasks for wake-up conditions */
     for (uint32_t i = 0; i < task_count; ++i) {
         if (task_list[i].state == TASK_BLOCKED && 
             task_list[i].sleep_until_tick != 0 &&
-            systick_ticks >= task_list[i].sleep_until_tick) {
+            tick_reached(systick_ticks, task_list[i].sleep_until_tick)) {
             
-            /* Wake up the task */
-            task_list[i].state = TASK_READY;
-            task_list[i].sleep_until_tick = 0;
+            /* Wake up the task; a timed wait also leaves its queue */
+            if (task_list[i].waiting_on != NULL) {
+                task_wake_waiter(&task_list[i], WAIT_TIMEOUT);
+            } else {
+                task_list[i].sleep_until_tick = 0;
+                task_set_state(&task_list[i], TASK_READY);
+                TRACE(TRACE_WAKE, &task_list[i], WAIT_TIMEOUT);
+            }
+        }
+
+#if SCHEDULER_LOAD_STATS
+        /* The scan visits every task anyway, so count the runnable ones here */
+        if ((task_list[i].state == TASK_READY || task_list[i].state == TASK_RUNNING) &&
+            task_list[i].sleep_until_tick == 0 && !task_list[i].is_idle) {
+            runnable++;
+        }
+#endif
+
+#if SCHEDULER_CPU_STATS
+        if (cpu_roll) {
+            cpu_stats_roll_task(&task_list[i]);
         }
+#endif
+    }
+
+#if SCHEDULER_LOAD_STATS
+    load_stats_tick(runnable);
+#endif
+
+#if SCHEDULER_CPU_STATS
+    if (cpu_roll) {
+        cpu_stats_roll_window();
+    }
+#endif
+
+#if KERNEL_BENCH
+    bench_record(BENCH_WAKE_SLEEPING, dwt_get_cycles() - bench_start);
+#endif
+}
+
+
+#if SCHEDULER_EDF
+/* Create a periodic EDF task, if the set stays schedulable */
+int32_t task_create_edf(void (*task_func)(void *), void *arg, size_t stack_size_bytes,
+                        const edf_params_t *params) {
+    if (params == NULL || params->period_ticks == 0 || params->budget_ticks == 0) {
+        return -1;
+    }
+
+    uint32_t deadline = (params->deadline_ticks != 0) ? params->deadline_ticks : params->period_ticks;
+    if (deadline > params->period_ticks || params->budget_ticks > deadline) {
+        return -1;
+    }
+
+    /* budget <= deadline, so density <= EDF_DENSITY_ONE */
+    uint32_t density = u64_div_u32((uint64_t)params->budget_ticks << 16, deadline);
+    uint32_t limit = (EDF_DENSITY_ONE * EDF_UTILIZATION_LIMIT_PCT) / 100u;
+
+    /* Reserve the bandwidth first, so concurrent creations cannot both pass */
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    if (edf_density_total + density > limit) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+    edf_density_total += density;
+    exit_critical_basepri(stat);
+
+    int32_t handle = task_create(task_func, arg, stack_size_bytes);
+
+    stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = (handle >= 0) ? task_from_handle((task_handle_t)handle) : NULL;
+    if (task == NULL) {
+        edf_density_total -= density;
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    edf_state_t *edf = &task->edf;
+    edf->params = *params;
+    edf->params.deadline_ticks = deadline;
+    edf->density = density;
+    edf->release = systick_ticks;
+    edf->deadline = edf->release + deadline;
+    edf->next_release = edf->release + params->period_ticks;
+    edf->budget_left = params->budget_ticks;
+    edf->enabled = 1;
+
+    task_set_effective_priority(task, EDF_TASK_PRIORITY);
+    task->base_priority = EDF_TASK_PRIORITY;
+
+    exit_critical_basepri(stat);
+
+    if (task_current != NULL) {
+        yield_cpu();    /* Its deadline may be the earliest */
+    }
+
+    return handle;
+}
+
+
+/* End the current job: account it, set up the next one and sleep until its release */
+int32_t task_wait_next_period(void) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *self = task_current;
+    if (self == NULL || !self->edf.enabled) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    edf_state_t *edf = &self->edf;
+    uint32_t now = systick_ticks;
+
+    if (!edf->missed && !tick_reached(edf->deadline, now)) {
+        edf->misses++;  /* Finished after its deadline, between two ticks' checks */
+    }
+    edf->jobs++;
+
+    uint32_t release = edf->next_release;
+    if (tick_reached(now, release + edf->params.period_ticks)) {
+        release = now;  /* A whole period behind: skip the missed releases */
     }
+
+    edf->release = release;
+    edf->deadline = release + edf->params.deadline_ticks;
+    edf->next_release = release + edf->params.period_ticks;
+    edf->budget_left = edf->params.budget_ticks;
+    edf->missed = 0;
+    edf->throttled = 0;
+
+    if (tick_reached(now, release)) {
+        exit_critical_basepri(stat);
+        return 0;       /* Next job is already due */
+    }
+
+    self->sleep_until_tick = wake_tick(release);
+    task_set_state(self, TASK_BLOCKED);
+    TRACE(TRACE_SLEEP, self, TRACE_ARG_SAT(release - now));
+
+    exit_critical_basepri(stat);
+
+    yield_cpu();
+    return 0;
 }
 
+
+/* Snapshot of a task's EDF state */
+int32_t task_get_edf_stats(task_handle_t handle, edf_state_t *stats) {
+    if (stats == NULL) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    if (task == NULL || !task->edf.enabled) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+    *stats = task->edf;
+
+    exit_critical_basepri(stat);
+    return 0;
+}
+
+
+uint32_t scheduler_edf_density(void) {
+    return edf_density_total;
+}
+
+
+/* SysTick: budgets, replenishment and deadline misses */
+void scheduler_edf_tick(void) {
+    uint32_t now = systick_ticks;
+
+    for (uint32_t i = 0; i < task_count; ++i) {
+        task_t *task = &task_list[i];
+        edf_state_t *edf = &task->edf;
+
+        if (!edf->enabled) {
+            continue;
+        }
+
+        /* A throttled job continues at its next release, with a new budget and deadline;
+         * the wake scan that follows makes it READY */
+        if (edf->throttled && tick_reached(now, edf->next_release)) {
+            edf->release = edf->next_release;
+            edf->deadline = edf->release + edf->params.deadline_ticks;
+            edf->next_release = edf->release + edf->params.period_ticks;
+            edf->budget_left = edf->params.budget_ticks;
+            edf->throttled = 0;
+            edf->missed = 0;
+        }
+
+        /* Released jobs only: a task waiting for its release has a deadline in the future */
+        if (!edf->missed && !tick_reached(edf->deadline, now)) {
+            edf->missed = 1;
+            edf->misses++;
+        }
+    }
+
+    /*
+     * Charge the tick to the EDF task it interrupted. The tick that uses up
+     * the budget throttles the job, so it never runs past its budget.
+     */
+    task_t *running = task_current;
+    if (running != NULL && running->edf.enabled && running->state == TASK_RUNNING) {
+        if (running->edf.budget_left != 0) {
+            running->edf.budget_left--;
+        }
+        if (running->edf.budget_left == 0) {
+            running->edf.overruns++;
+            running->edf.throttled = 1;
+            running->sleep_until_tick = wake_tick(running->edf.next_release);
+            task_set_state(running, TASK_BLOCKED);  /* SysTick's yield switches it out */
+        }
+    }
+}
+#endif
+
+
+/* Empty wait queue */
+void wait_queue_init(wait_queue_t *queue) {
+    queue->head = NULL;
+}
+
+
+/* Block the running task with an optional SysTick deadline */
+static void task_block_with_timeout(task_t *self, uint32_t timeout_ticks) {
+    if (timeout_ticks == WAIT_FOREVER) {
+        self->sleep_until_tick = 0;
+    } else {
+        self->sleep_until_tick = wake_tick(systick_ticks + timeout_ticks);
+    }
+
+    task_set_state(self, TASK_BLOCKED);
+    TRACE(TRACE_BLOCK, self, timeout_ticks == WAIT_FOREVER ? 0xFFFFu : TRACE_ARG_SAT(timeout_ticks));
+}
+
+
+/* Queue the running task and arm its timeout; the switch happens in task_wait_end() */
+void task_wait_begin(wait_queue_t *queue, uint32_t timeout_ticks) {
+    task_t *self = task_current;
+
+    self->wait_result = WAIT_TIMEOUT;
+    wait_queue_insert(queue, self);
+    task_block_with_timeout(self, timeout_ticks);
+}
+
+
+/* Switch away with BASEPRI dropped; returns after a wake or timeout */
+int32_t task_wait_end(uint32_t basepri_state) {
+    exit_critical_basepri(basepri_state);
+    yield_cpu();
+
+    return task_current->wait_result;
+}
+
+
+int32_t task_wait(wait_queue_t *queue, uint32_t timeout_ticks, uint32_t basepri_state) {
+    task_wait_begin(queue, timeout_ticks);
+    return task_wait_end(basepri_state);
+}
+
+
+/* Wake the head of the queue (highest priority, longest waiting) */
+task_t *wait_queue_wake_one(wait_queue_t *queue, int32_t result) {
+    task_t *task = queue->head;
+    if (task == NULL) {
+        return NULL;
+    }
+
+    task_wake_waiter(task, result);
+    task_preempt_check(task);
+
+    return task;
+}
+
+
+/* Wake one particular waiter */
+void wait_queue_wake_task(task_t *task, int32_t result) {
+    if (task->waiting_on == NULL) {
+        return;
+    }
+
+    task_wake_waiter(task, result);
+    task_preempt_check(task);
+}
+
+
+/* Wake every waiter */
+uint32_t wait_queue_wake_all(wait_queue_t *queue, int32_t result) {
+    uint32_t woken = 0;
+
+    while (wait_queue_wake_one(queue, result) != NULL) {
+        woken++;
+    }
+
+    return woken;
+}
+
+
+/* New effective priority; a waiter is re-inserted to keep its queue sorted */
+void task_set_effective_priority(task_t *task, uint8_t priority) {
+    if (task->priority == priority) {
+        return;
+    }
+
+    /* A ready task changes queues */
+    uint8_t ready = (task->state == TASK_READY);
+    if (ready) {
+        ready_remove(task);
+    }
+    task->priority = priority;
+    if (ready) {
+        ready_push(task);
+    }
+
+    wait_queue_t *queue = task->waiting_on;
+    if (queue != NULL) {
+        wait_queue_remove(task);
+        wait_queue_insert(queue, task);
+    }
+}
+
+
+/* Update the notification word and release the task if it is waiting for it */
+int32_t task_notify(task_handle_t handle, uint32_t value, notify_action_t action) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    task_t *task = task_from_handle(handle);
+    if (task == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+
+    switch (action) {
+        case NOTIFY_SET_BITS:  task->notify_value |= value; break;
+        case NOTIFY_INCREMENT: task->notify_value++;        break;
+        case NOTIFY_OVERWRITE: task->notify_value = value;  break;
+        default: break;
+    }
+
+    uint8_t was_waiting = (task->notify_state == NOTIFY_STATE_WAITING);
+    task->notify_state = NOTIFY_STATE_PENDING;
+
+    if (was_waiting && task->state == TASK_BLOCKED) {
+        task->sleep_until_tick = 0;
+        task_set_state(task, TASK_READY);
+        TRACE(TRACE_WAKE, task, WAIT_OK);
+        task_preempt_check(task);
+    }
+
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+
+
+/* Block (no wait queue involved) until task_notify() or the timeout */
+int32_t task_notify_wait(uint32_t clear_on_exit, uint32_t *value_out, uint32_t timeout_ticks) {
+    if (task_current == NULL || in_isr()) {
+        return WAIT_TIMEOUT;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    task_t *self = task_current;
+
+    if (self->notify_state != NOTIFY_STATE_PENDING && timeout_ticks != 0) {
+        self->notify_state = NOTIFY_STATE_WAITING;
+        task_block_with_timeout(self, timeout_ticks);
+
+        exit_critical_basepri(stat);
+        yield_cpu();
+        stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    }
+
+    /* Woken by the SysTick deadline (or task_unblock) if nothing is pending */
+    int32_t result = WAIT_TIMEOUT;
+    if (self->notify_state == NOTIFY_STATE_PENDING) {
+        if (value_out != NULL) {
+            *value_out = self->notify_value;
+        }
+        self->notify_value &= ~clear_on_exit;
+        result = WAIT_OK;
+    }
+    self->notify_state = NOTIFY_STATE_NONE;
+
+    exit_critical_basepri(stat);
+
+    return result;
+}
@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include "device_registers.h"
 #include "project_config.h"
+#include "cycle_stats.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,31 +17,32 @@ extern "C" {
  * 
  * STATIC ALLOCATION MODE (TASK_ALLOC_STATIC):
  * --------------------------------------------
- * - Each task TCB: ~1032 bytes
- *   - psp: 4 bytes
- *   - sleep_until_tick: 4 bytes
- *   - stack[255]: 1020 bytes (255 words * 4 bytes)
- *   - state: 1 byte
- *   - is_idle: 1 byte
- *   - task_id: 2 bytes
+ * - Each task TCB: ~60 bytes, as in dynamic mode
+ * - Stack pool: TASK_STATIC_STACKS * 1024 bytes (255 words padded to 8-byte alignment)
+ *   - task_create() takes one, the idle task included
+ *   - task_create_static() tasks reserve none
  * 
- * - Global task_list[58]: 58 * 1032 = ~60 KB
+ * - Global task_list[58]: 58 * 60 = ~3.4 KB
+ * - Stack pool[58]: 58 * 1024 = ~58 KB
  * - Other globals (.data/.bss): ~4 KB
- * - Remaining for heap: ~32 KB (mostly unused)
+ * - Remaining for heap: ~30 KB (mostly unused)
  * - Max tasks: ~58 (limited by task_list array size)
  * 
  * DYNAMIC ALLOCATION MODE (TASK_ALLOC_DYNAMIC):
  * ----------------------------------------------
- * - Each task TCB: ~16 bytes
+ * - Each task TCB: ~60 bytes
  *   - psp: 4 bytes
  *   - sleep_until_tick: 4 bytes
  *   - stack_ptr: 4 bytes (pointer only)
  *   - stack_size: 4 bytes
+ *   - stack_external: 1 byte
  *   - state: 1 byte
  *   - is_idle: 1 byte
- *   - task_id: 2 bytes
+ *   - generation: 2 bytes
+ *   - handle: 4 bytes
+ *   - priorities, wait queue, mutex, event and notify state: 36 bytes
  * 
- * - Global task_list[58]: 58 * 16 = ~928 bytes
+ * - Global task_list[58]: 58 * 60 = ~3.4 KB
  * - Each task stack (heap): 1020 bytes
  * - Other globals (.data/.bss): ~4 KB
  * - Total heap available: ~92 KB
@@ -50,6 +52,120 @@ extern "C" {
  * active tasks, as stacks are only allocated when tasks are created.
  */
 #define EXC_RETURN_THREAD_PSP       0xFFFFFFFDu   /* EXC_RETURN: return to Thread mode, use PSP */
+#define EXC_RETURN_FTYPE_MASK       (1u << 4)     /* EXC_RETURN FType: 0 = frame holds FPU state */
+#define EXC_RETURN_THREAD_PSP_MASK  0x0Cu         /* EXC_RETURN bits 3:2 set: came from Thread mode on PSP */
+
+/*
+ * Saved context layout (see context_switch.S):
+ *   psp[0..7]  R4-R11
+ *   psp[8]     EXC_RETURN of the task
+ *   psp[9..24] S16-S31, only when EXC_RETURN FType is 0
+ *   then the hardware exception frame
+ */
+#define TASK_FRAME_EXC_RETURN_WORD  8u
+#define TASK_FRAME_SW_WORDS         9u            /* R4-R11 + EXC_RETURN */
+
+/*
+ * Task handles
+ * ============
+ * A handle is an opaque 32-bit value that encodes the task_list[] slot index
+ * in its low byte and the slot's generation counter above it:
+ *
+ *   [31:24] reserved (0)   [23:8] generation   [7:0] slot index
+ *
+ * The generation is bumped every time a slot is reused, so a handle kept
+ * after its task died no longer matches the slot and is rejected instead of
+ * silently addressing the new occupant. Lookup is a single array index.
+ * Generation 0 is never issued, so 0 is never a valid handle.
+ */
+typedef uint32_t task_handle_t;
+
+#define TASK_HANDLE_INVALID         0u
+#define TASK_HANDLE_INDEX_BITS      8u
+#define TASK_HANDLE_INDEX_MASK      ((1u << TASK_HANDLE_INDEX_BITS) - 1u)
+#define TASK_HANDLE_MAKE(idx, gen)  (((uint32_t)(gen) << TASK_HANDLE_INDEX_BITS) | (uint32_t)(idx))
+#define TASK_HANDLE_INDEX(h)        ((uint32_t)(h) & TASK_HANDLE_INDEX_MASK)
+#define TASK_HANDLE_GENERATION(h)   ((uint16_t)((uint32_t)(h) >> TASK_HANDLE_INDEX_BITS))
+
+#if MAX_TASKS > TASK_HANDLE_INDEX_MASK
+    #error "MAX_TASKS does not fit in the task handle slot index field"
+#endif
+
+/* Exit codes reported by task_join() besides the task's own */
+#define TASK_EXIT_OK                0       /* Returned from its entry function or task_exit() */
+#define TASK_EXIT_DELETED           (-1)    /* Removed by task_delete() */
+#define TASK_EXIT_FAULT             (-2)    /* Killed after a stack overflow */
+
+/* Called once when a task ends; see task_set_exit_callback() */
+typedef void (*task_exit_callback_t)(task_handle_t handle, int32_t exit_code, void *arg);
+
+#if SCHEDULER_EDF
+/* Periodic real-time contract of an EDF task, in SysTick ticks */
+typedef struct edf_params {
+    uint32_t period_ticks;      /* Release interval of the jobs */
+    uint32_t deadline_ticks;    /* Relative deadline of each job, 0 = period */
+    uint32_t budget_ticks;      /* Worst-case execution time per job */
+} edf_params_t;
+
+/* task_t.edf: per-task EDF state */
+typedef struct edf_state {
+    edf_params_t params;
+    uint8_t   enabled;          /* Member of the EDF class */
+    uint8_t   throttled;        /* Budget used up, parked until next_release */
+    uint8_t   missed;           /* Current job already counted as a miss */
+    uint32_t  release;          /* Release tick of the current job */
+    uint32_t  deadline;         /* Absolute deadline of the current job */
+    uint32_t  next_release;
+    uint32_t  budget_left;      /* Ticks the current job may still run */
+    uint32_t  density;          /* budget / min(deadline, period), 1/65536 units */
+    uint32_t  jobs;             /* Jobs completed */
+    uint32_t  misses;           /* Jobs still unfinished at their deadline */
+    uint32_t  overruns;         /* Jobs that exhausted their budget */
+} edf_state_t;
+
+#define EDF_DENSITY_ONE         65536u  /* Density of a task using the whole CPU */
+#endif
+
+/* Task priorities (higher number runs first) */
+#define TASK_PRIORITY_IDLE          0u
+#define TASK_PRIORITY_MIN           1u
+#define TASK_PRIORITY_MAX           (TASK_PRIORITY_LEVELS - 1u)
+
+/*
+ * Wait queues
+ * ===========
+ * The building block of the blocking primitives (mutex, ...). A blocked task
+ * is linked into the queue through its TCB, so waiting never allocates.
+ * Waiters are kept in priority order, FIFO among equal priorities, and an
+ * optional timeout reuses sleep_until_tick, so SysTick expires waits and
+ * sleeps with the same scan.
+ */
+struct task_struct;
+
+typedef struct wait_queue {
+    struct task_struct *head;   /* Highest-priority waiter */
+} wait_queue_t;
+
+#define WAIT_QUEUE_INIT             { NULL }
+#define WAIT_FOREVER                0xFFFFFFFFu   /* Timeout: block until woken */
+
+typedef enum wait_result {
+    WAIT_OK      = 0,   /* Woken by the primitive (lock handed over, ...) */
+    WAIT_TIMEOUT = -1,  /* Timeout expired first */
+    WAIT_ABORTED = -2   /* Forced awake with task_unblock() */
+} wait_result_t;
+
+/* Direct-to-task notifications: what task_notify() does to the value */
+typedef enum notify_action {
+    NOTIFY_SET_BITS = 0,    /* value |= arg (event flags) */
+    NOTIFY_INCREMENT,       /* value++ (counting semaphore), arg ignored */
+    NOTIFY_OVERWRITE        /* value = arg (mailbox) */
+} notify_action_t;
+
+/* task_t.notify_state */
+#define NOTIFY_STATE_NONE       0u  /* Nothing pending, not waiting */
+#define NOTIFY_STATE_WAITING    1u  /* Blocked in task_notify_wait() */
+#define NOTIFY_STATE_PENDING    2u  /* Notified, not yet consumed */
 
 typedef enum task_state {
     TASK_UNUSED = 0,
@@ -66,20 +182,115 @@ typedef enum task_return {
     TASK_DELETE_IS_CURRENT_TASK = -3
 } task_return_t;
 
+typedef enum task_join_status {
+    TASK_JOIN_OK            = 0,
+    TASK_JOIN_ERR_TIMEOUT   = -1,   /* Still running at the timeout */
+    TASK_JOIN_ERR_NOT_FOUND = -2,   /* Invalid handle, or it exited and the slot was reused */
+    TASK_JOIN_ERR_SELF      = -3,   /* A task cannot join itself */
+    TASK_JOIN_ERR_ISR       = -4,   /* Blocking join from an interrupt handler */
+    TASK_JOIN_ERR_ABORTED   = -5    /* Wait cut short by task_unblock() */
+} task_join_status_t;
+
 typedef struct task_struct {
     uint32_t *psp;
     uint32_t  sleep_until_tick; /* SysTick count when task should wake (0 = not sleeping) */
-#if TASK_STACK_ALLOC_MODE == TASK_ALLOC_STATIC
-    uint32_t  stack[STACK_SIZE_IN_WORDS] __attribute__((aligned(8)));  /* Embedded stack for static mode */
-#else
-    uint32_t *stack_ptr;  /* Pointer to dynamically allocated stack for dynamic mode */
-    uint32_t  stack_size; /* Size of allocated stack in bytes */
+    uint32_t *stack_ptr;  /* Stack memory: heap block, pool stack or caller's buffer */
+    uint32_t  stack_size; /* Size of the stack memory in bytes */
+    uint8_t   stack_external; /* Stack from task_create_static(): owned by the caller, never freed */
+#if STACK_MPU_GUARD
+    uintptr_t stack_guard;      /* Base of the MPU guard region at the stack bottom */
+#endif
+#if STACK_PROFILE
+    uintptr_t entry;            /* Entry function, identifies the call site in the stack profile */
 #endif
     uint8_t   state;
     uint8_t   is_idle;          /* Flag for idle task */
-    uint16_t  task_id;
+    uint16_t  generation;       /* Bumped on every slot reuse, kept across deletion */
+    task_handle_t handle;       /* Handle of the current occupant (0 = none) */
+    uint8_t   priority;         /* Effective priority, raised by priority inheritance */
+    uint8_t   base_priority;    /* Priority set by task_set_priority() */
+    int8_t    wait_result;      /* wait_result_t of the last wait */
+    wait_queue_t *waiting_on;   /* Queue the task is blocked on (NULL = none) */
+    struct task_struct *wait_next; /* Next waiter in that queue, or next zombie to reap */
+    struct task_struct *ready_next; /* Ready queue of its priority level, while TASK_READY */
+    struct task_struct *ready_prev;
+    struct mutex *mutex_held;   /* Mutexes owned, most recently locked first */
+    struct mutex *mutex_blocked_on; /* Mutex the task waits for (NULL = none) */
+    uint32_t  event_mask;       /* Event group bits waited for */
+    uint32_t  event_bits;       /* Group bits that satisfied the wait */
+    uint8_t   event_options;    /* EVENT_WAIT_ALL / EVENT_CLEAR_ON_EXIT */
+    uint8_t   notify_state;     /* NOTIFY_STATE_* */
+    uint32_t  notify_value;     /* Direct-to-task notification word */
+    int32_t   exit_code;        /* Set when the task ends, readable until the slot is reused */
+    int32_t   join_code;        /* Exit code handed to this task by task_join() */
+    wait_queue_t joiners;       /* Tasks blocked in task_join() on this one */
+    task_exit_callback_t exit_callback;
+    void     *exit_callback_arg;
+#if SCHEDULER_EDF
+    edf_state_t edf;
+#endif
+#if SCHEDULER_CPU_STATS
+    uint32_t  run_cycles;       /* Cycles run in the current slice */
+    uint32_t  run_cycles_slice[CPU_STATS_WINDOW_SLICES]; /* Complete slices, by slice index */
+    uint32_t  run_cycles_last;  /* Cycles run in the sliding window (sum of the slices) */
+    uint32_t  max_run_cycles;   /* Longest time on the CPU without being switched out */
+    uint32_t  switch_count;     /* Times the task was switched in */
+#endif
 } task_t;
 
+/* CPU usage over the sliding accounting window (SCHEDULER_CPU_STATS) */
+typedef struct cpu_window_stats {
+    uint32_t window_cycles; /* Length of the window in cycles */
+    uint32_t idle_cycles;   /* Cycles spent in the idle task */
+} cpu_window_stats_t;
+
+/* Load averages and ready-queue length (SCHEDULER_LOAD_STATS), fixed point */
+#define LOAD_FIXED_SHIFT    16
+#define LOAD_FIXED_ONE      (1UL << LOAD_FIXED_SHIFT)   /* 1.0 */
+
+typedef struct load_stats {
+    uint32_t load_1s;       /* Runnable tasks (running + ready, idle excluded) */
+    uint32_t load_10s;
+    uint32_t load_60s;
+    uint32_t ready_avg;     /* Mean tasks ready but waiting for the CPU, per tick */
+    uint32_t ready_max;     /* Most tasks seen waiting at one tick (plain count) */
+} load_stats_t;
+
+#if STACK_WATERMARK
+/* Stack usage of one task, in bytes */
+typedef struct task_stack_info {
+    uint32_t size;      /* Whole stack, including the canary word */
+    uint32_t used;      /* In use right now (as of the last switch for other tasks) */
+    uint32_t peak;      /* Deepest usage since creation (painted words overwritten) */
+} task_stack_info_t;
+#endif
+
+#if STACK_MPU_GUARD
+/* Last task killed by its stack guard */
+typedef struct stack_fault_info {
+    uint32_t      count;        /* Tasks killed since boot */
+    task_handle_t handle;       /* Handle the task had */
+    uint32_t      address;      /* Faulting data address (0 if not captured) */
+    uint32_t      mmfsr;        /* MemManage fault status bits */
+} stack_fault_info_t;
+#endif
+
+#if STACK_MPU_GUARD
+#define TASK_STACK_ALIGN        STACK_GUARD_SIZE
+#define TASK_STACK_GUARD_BYTES  STACK_GUARD_SIZE
+#else
+#define TASK_STACK_ALIGN        8u
+#define TASK_STACK_GUARD_BYTES  0u
+#endif
+
+/* Stack buffer for task_create_static() with 'bytes' usable; pass sizeof(name) as the size */
+#define TASK_STACK_DEFINE(name, bytes) \
+    uint32_t name[((bytes) + TASK_STACK_GUARD_BYTES) / sizeof(uint32_t)] \
+        __attribute__((aligned(TASK_STACK_ALIGN)))
+
+/* Place a TASK_STACK_DEFINE buffer in SRAM2, below the main stack (not zeroed at boot) */
+#define TASK_STACK_SRAM2        __attribute__((section(".sram2_stacks")))
+
 /* Globals */
 extern task_t task_list[MAX_TASKS];
 extern task_t  *task_current;
@@ -96,10 +307,12 @@ void scheduler_init(void);
 /**
  * @brief Create a new task
  * 
+ * The task starts at TASK_PRIORITY_DEFAULT; see task_set_priority().
+ * 
  * @param task_func Entry function for the task
  * @param arg Argument to pass to the task function
  * @param stack_size_bytes Stack size in bytes (DYNAMIC mode only, ignored in STATIC mode)
- * @return Task ID on success, -1 on failure
+ * @return Task handle (task_handle_t) on success, -1 on failure
  * 
  * @note In STATIC mode, stack_size_bytes is ignored (uses STACK_SIZE_BYTES)
  * @note In DYNAMIC mode, stack_size_bytes must be >= STACK_MIN_SIZE_BYTES
@@ -107,6 +320,26 @@ void scheduler_init(void);
 int32_t task_create(void (*task_func)(void *), void *arg, size_t stack_size_bytes);
 
 
+/**
+ * @brief Create a task on a stack provided by the caller.
+ * 
+ * No heap is touched: the TCB is a slot of the kernel's task table and the
+ * stack is the caller's buffer, typically a static array placed by the
+ * linker (see TASK_STACK_DEFINE and TASK_STACK_SRAM2). The buffer must stay
+ * valid until the task has been reaped; the kernel never frees it. Works in
+ * both allocation modes, next to task_create() tasks.
+ * 
+ * With STACK_MPU_GUARD the guard region is carved out of the buffer, so
+ * declare it with TASK_STACK_DEFINE, which adds and aligns the room.
+ * 
+ * @param stack 8-byte aligned stack buffer
+ * @param stack_size_bytes Size of the buffer; what is left after the guard
+ *        must be at least STACK_MIN_SIZE_BYTES
+ * @return Task handle (task_handle_t) on success, -1 on failure
+ */
+int32_t task_create_static(void (*task_func)(void *), void *arg, uint32_t *stack, size_t stack_size_bytes);
+
+
 /**
  * @brief Start the scheduler and run the first task
  * 
@@ -121,20 +354,105 @@ void scheduler_start(void);
 void schedule_next_task(void);
 
 
+/**
+ * @brief Resolve a task handle to its TCB in O(1).
+ * 
+ * @param handle Handle returned by task_create()
+ * @return Pointer to the task, or NULL if the handle is invalid or stale
+ */
+task_t *task_from_handle(task_handle_t handle);
+
+
+/**
+ * @brief Get the handle of the calling task
+ * 
+ * @return Handle of task_current, or TASK_HANDLE_INVALID before the scheduler runs
+ */
+task_handle_t task_get_current_handle(void);
+
+
+#if CONTEXT_SWITCH_PROFILING
+/**
+ * @brief Get cycle statistics of context switches, split by frame class.
+ * 
+ * A switch counts as FPU when the outgoing or incoming task had live FPU
+ * state, i.e. PendSV had to save or restore S16-S31.
+ * Requires dwt_init() to have been called, otherwise all samples read 0.
+ * 
+ * @param integer Filled with stats for integer-only switches (may be NULL)
+ * @param fpu     Filled with stats for switches that saved FPU state (may be NULL)
+ */
+void scheduler_get_switch_stats(cycle_stats_t *integer, cycle_stats_t *fpu);
+#endif
+
+
+#if SCHEDULER_CPU_STATS
+/**
+ * @brief Get the length and idle time of the sliding CPU accounting window.
+ * 
+ * The window is made of the last CPU_STATS_WINDOW_SLICES complete slices, so
+ * it is shorter than CPU_STATS_WINDOW_TICKS only right after boot.
+ * 
+ * Per-task figures for the same window are in task_t.run_cycles_last.
+ * 
+ * @param stats Filled with the window statistics
+ */
+void scheduler_get_cpu_window(cpu_window_stats_t *stats);
+#endif
+
+
+#if SCHEDULER_LOAD_STATS
+/**
+ * @brief Get the 1 s / 10 s / 60 s load averages and ready-queue statistics.
+ *
+ * All averages are in LOAD_FIXED_ONE units. The ready-queue mean and peak
+ * cover the whole uptime.
+ */
+void scheduler_get_load_stats(load_stats_t *stats);
+#endif
+
+
+/**
+ * @brief Set the base priority of a task.
+ * 
+ * While the task holds a mutex that a more urgent task waits for, it keeps
+ * running at the inherited priority until it unlocks.
+ * 
+ * @param handle Handle of the task
+ * @param priority TASK_PRIORITY_MIN .. TASK_PRIORITY_MAX
+ * @return 0 on success, -1 if the handle or priority is invalid
+ */
+int32_t task_set_priority(task_handle_t handle, uint8_t priority);
+
+
+/**
+ * @brief Get the effective priority of a task (base or inherited).
+ * 
+ * @param handle Handle of the task
+ * @return Priority, or -1 if the handle is invalid or stale
+ */
+int32_t task_get_priority(task_handle_t handle);
+
+
 /**
  * @brief Block a task (prevent it from being scheduled)
  * 
- * @param task Pointer to the task to block
+ * @param handle Handle of the task to block
+ * @return 0 on success, -1 if the handle is invalid or stale
  */
-void task_block(task_t *task);
+int32_t task_block(task_handle_t handle);
 
 
 /**
  * @brief Unblock a task (make it ready to run)
  * 
- * @param task Pointer to the task to unblock
+ * A task waiting on a wait queue is removed from it and its wait returns
+ * WAIT_ABORTED. Safe to call from ISRs at or below MAX_SYSCALL_PRIORITY.
+ * 
+ * @param handle Handle of the task to unblock
+ * @return 0 on success, -1 if the handle is invalid or stale
  */
-void task_unblock(task_t *task);
+int32_t task_unblock(task_handle_t handle);
 
 
 /**
@@ -147,10 +465,11 @@ void task_block_current(void);
 /**
  * @brief Delete a task
  * 
- * @param task_id ID of the task to delete
- * @return TASK_DELETE_SUCCESS on success, otherwise failure
+ * @param handle Handle of the task to delete
+ * @return TASK_DELETE_SUCCESS on success, TASK_DELETE_TASK_NOT_FOUND if the
+ *         handle is invalid or stale, otherwise failure
  */
-int32_t task_delete(uint16_t task_id);
+int32_t task_delete(task_handle_t handle);
 
 
 /**
@@ -160,16 +479,159 @@ int32_t task_delete(uint16_t task_id);
 void task_check_stack_overflow(void);
 
 
+#if STACK_WATERMARK
+/**
+ * @brief Measure a task's stack usage and high-water mark.
+ * 
+ * Scans the painted area word by word from the bottom, so the cost is
+ * proportional to the stack the task has never touched.
+ * 
+ * @param handle Handle of the task
+ * @param info Filled with the figures
+ * @return 0 on success, -1 if the handle is invalid or stale
+ */
+int32_t task_get_stack_info(task_handle_t handle, task_stack_info_t *info);
+#endif
+
+
+#if STACK_MPU_GUARD
+/**
+ * @brief Get the record of the last task killed by a stack guard fault.
+ * 
+ * @param info Filled with the record (count 0 if none yet)
+ */
+void scheduler_get_stack_fault(stack_fault_info_t *info);
+
+
+/**
+ * @brief Internal function: MemManage handling for stack guard hits.
+ * Called by MemManage_Handler in context_switch.S.
+ * 
+ * A fault raised by task code (thread mode on PSP) is recorded and the task
+ * is restarted on a fresh frame at the top of its own stack in task_exit().
+ * 
+ * @param exc_return EXC_RETURN of the faulting context
+ * @return PSP to return the task with, or 0 if the fault is not recoverable
+ */
+uint32_t scheduler_stack_fault(uint32_t exc_return);
+#endif
+
+
 /**
  * @brief Allows a running task to voluntarily delete itself.
- * This function marks the task for deletion and yields the CPU.
+ * Same as task_exit_with_code(TASK_EXIT_OK); also where a task lands
+ * when its entry function returns.
  */
 void task_exit(void);
 
 
 /**
- * @brief Rearrange the task list, delete unused tasks.
+ * @brief End the calling task with an exit code for task_join().
  * 
+ * Runs the exit callback (if any) on the task's own stack, wakes every
+ * joiner, then queues the task for reaping and switches away from it for
+ * good. Does not return.
+ * 
+ * @param exit_code Value handed to joiners (negative values are used by the kernel)
+ */
+void task_exit_with_code(int32_t exit_code);
+
+
+/**
+ * @brief Wait for a task to end and collect its exit code.
+ * 
+ * Any number of tasks may join the same task. The exit code stays readable
+ * after the task is gone until its slot is reused by task_create(), so
+ * creating all workers first and joining them afterwards never loses one.
+ * 
+ * @param handle Task to wait for
+ * @param timeout_ticks SysTick ticks to wait, 0 to poll, WAIT_FOREVER to block
+ * @param exit_code Set to the task's exit code on TASK_JOIN_OK (may be NULL)
+ * @return TASK_JOIN_OK or a negative task_join_status_t
+ */
+int32_t task_join(task_handle_t handle, uint32_t timeout_ticks, int32_t *exit_code);
+
+
+/**
+ * @brief Register a function to call when a task ends.
+ * 
+ * On task_exit() or return it runs in the ending task itself; on
+ * task_delete() it runs in the caller of task_delete(), with
+ * TASK_EXIT_DELETED. Replaces any previous callback; NULL removes it.
+ * 
+ * @return 0 on success, -1 if the handle is invalid or stale
+ */
+int32_t task_set_exit_callback(task_handle_t handle, task_exit_callback_t callback, void *arg);
+
+
+#if SCHEDULER_EDF
+/**
+ * @brief Create a periodic task in the earliest-deadline-first class.
+ * 
+ * The task runs at EDF_TASK_PRIORITY, and among EDF tasks the one whose
+ * current job has the earliest absolute deadline runs first. Its first
+ * job is released at once. The body does one job per loop iteration and
+ * then calls task_wait_next_period().
+ * 
+ * Admission: the task is refused if the sum over all EDF tasks of
+ * budget / min(deadline, period) would exceed EDF_UTILIZATION_LIMIT_PCT.
+ * That is exact for deadline == period and sufficient otherwise.
+ * 
+ * A job still running at the tick that uses up its budget is throttled
+ * until its next release, then continues with a fresh budget and deadline, so an
+ * overrunning task cannot steal time from the others. A job unfinished at
+ * its deadline counts as a miss.
+ * 
+ * @return Task handle on success, -1 on bad parameters, failed admission
+ *         or failed task creation
+ */
+int32_t task_create_edf(void (*task_func)(void *), void *arg, size_t stack_size_bytes,
+                        const edf_params_t *params);
+
+
+/**
+ * @brief End the current job and block until the next release.
+ * 
+ * Returns at once if the next release has already passed. A task more than
+ * a whole period behind skips the missed releases.
+ * 
+ * @return 0 on success, -1 if the caller is not an EDF task
+ */
+int32_t task_wait_next_period(void);
+
+
+/**
+ * @brief Copy the EDF state of a task (parameters, job/miss/overrun counts).
+ * 
+ * @return 0 on success, -1 if the handle is stale or not an EDF task
+ */
+int32_t task_get_edf_stats(task_handle_t handle, edf_state_t *stats);
+
+
+/**
+ * @brief Admitted EDF density, in 1/65536 of the CPU.
+ */
+uint32_t scheduler_edf_density(void);
+
+
+/**
+ * @brief Charge the running EDF task one tick of budget, replenish
+ * throttled ones and count deadline misses. Called by SysTick_Handler
+ * before scheduler_wake_sleeping_tasks().
+ */
+void scheduler_edf_tick(void);
+#endif
+
+
+/**
+ * @brief Release the slots and stacks of exited and deleted tasks.
+ * 
+ * Only walks the queue of zombies, so the cost is proportional to the
+ * number of tasks reaped. schedule_next_task() does the same on every
+ * switch that finds the queue non-empty, so a task is reaped by the first
+ * context switch after it left the CPU; call this to get the memory back
+ * before that. Slots are reclaimed in place (tasks are never moved), so
+ * handles and task_t pointers of live tasks stay valid. Task context only.
  */
 void task_garbage_collection(void);
 
@@ -187,6 +649,37 @@ void task_garbage_collection(void);
 int task_sleep_ticks(uint32_t ticks);
 
 
+/**
+ * @brief Notify a task directly (no separate object, no extra RAM).
+ * 
+ * Updates the task's notification word and, if it is blocked in
+ * task_notify_wait(), makes it ready, pending PendSV when it outranks the
+ * running task. The cheapest ISR-to-task signal; safe from ISRs at or below
+ * MAX_SYSCALL_PRIORITY.
+ * 
+ * @param handle Task to notify
+ * @param value Bits to set / value to write (ignored for NOTIFY_INCREMENT)
+ * @param action How to update the notification word
+ * @return 0 on success, -1 if the handle is invalid or stale
+ */
+int32_t task_notify(task_handle_t handle, uint32_t value, notify_action_t action);
+
+
+/**
+ * @brief Wait for a notification to the calling task.
+ * 
+ * Returns at once if one is already pending. Notifications sent meanwhile
+ * are merged into the word, so none is lost while the task is busy.
+ * 
+ * @param clear_on_exit Bits of the word to clear once it has been read
+ *        (0xFFFFFFFF resets it, e.g. to consume a NOTIFY_INCREMENT count)
+ * @param value_out Notification word before clearing (may be NULL)
+ * @param timeout_ticks SysTick ticks to wait, 0 to poll, WAIT_FOREVER to block
+ * @return WAIT_OK, or WAIT_TIMEOUT if nothing arrived (also after task_unblock())
+ */
+int32_t task_notify_wait(uint32_t clear_on_exit, uint32_t *value_out, uint32_t timeout_ticks);
+
+
 /**
  * @brief Internal function: wake up any sleeping tasks whose wake-up time has arrived.
  * Called by SysTick_Handler in systick.c.
@@ -194,6 +687,97 @@ int task_sleep_ticks(uint32_t ticks);
 void scheduler_wake_sleeping_tasks(void);
 
 
+/* ---------- Kernel-internal API for blocking primitives ----------
+ * Everything below must be called with BASEPRI raised
+ * (enter_critical_basepri(MAX_SYSCALL_BASEPRI)).
+ */
+
+/**
+ * @brief Initialize an empty wait queue.
+ */
+void wait_queue_init(wait_queue_t *queue);
+
+
+/**
+ * @brief Put the calling task on a wait queue and mark it blocked.
+ * 
+ * Nothing is switched yet; the caller can still adjust state (e.g. priority
+ * inheritance) before task_wait_end() drops BASEPRI and yields.
+ * 
+ * @param queue Queue to wait on
+ * @param timeout_ticks Ticks until WAIT_TIMEOUT, or WAIT_FOREVER (must be > 0)
+ */
+void task_wait_begin(wait_queue_t *queue, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Leave the critical section, switch away and return once woken.
+ * 
+ * @param basepri_state Value returned by the caller's enter_critical_basepri()
+ * @return wait_result_t of the wait
+ */
+int32_t task_wait_end(uint32_t basepri_state);
+
+
+/**
+ * @brief Block the calling task on a queue (task_wait_begin + task_wait_end).
+ */
+int32_t task_wait(wait_queue_t *queue, uint32_t timeout_ticks, uint32_t basepri_state);
+
+
+/**
+ * @brief Wake the highest-priority waiter.
+ * 
+ * Requests a context switch if the woken task outranks the running one.
+ * Safe from ISRs at or below MAX_SYSCALL_PRIORITY.
+ * 
+ * @param queue Queue to wake from
+ * @param result Value its wait returns (normally WAIT_OK)
+ * @return The woken task, or NULL if the queue was empty
+ */
+task_t *wait_queue_wake_one(wait_queue_t *queue, int32_t result);
+
+
+/**
+ * @brief Wake a specific waiter, wherever it is in its queue.
+ * 
+ * For primitives that pick waiters by their own condition (event groups).
+ * Requests a context switch if the woken task outranks the running one.
+ * 
+ * @param task A task currently blocked on a wait queue
+ * @param result Value its wait returns
+ */
+void wait_queue_wake_task(task_t *task, int32_t result);
+
+
+/**
+ * @brief Wake every waiter (see wait_queue_wake_one).
+ * 
+ * @return Number of tasks woken
+ */
+uint32_t wait_queue_wake_all(wait_queue_t *queue, int32_t result);
+
+
+/**
+ * @brief Change the effective priority of a task, keeping its wait queue sorted.
+ * 
+ * Used by priority inheritance; the base priority is left untouched. A ready
+ * task moves to the back of its new level's ready queue.
+ */
+void task_set_effective_priority(task_t *task, uint8_t priority);
+
+
+/**
+ * @brief Change a task's state, keeping the ready queues in step.
+ * 
+ * Every task in TASK_READY (the idle task included, at level 0) sits in the
+ * FIFO of its priority level; entering TASK_READY appends it at the back and
+ * any other state takes it out. The running task is not queued. Caller holds
+ * the critical section.
+ */
+void task_set_state(task_t *task, uint8_t state);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,75 @@
+#include "semaphore.h"
+#include "utils.h"
+
+
+int32_t semaphore_init(semaphore_t *sem, uint32_t initial_count, uint32_t max_count) {
+    if (sem == NULL || max_count == 0) {
+        return SEM_ERR_PARAM;
+    }
+
+    sem->count = (initial_count > max_count) ? max_count : initial_count;
+    sem->max_count = max_count;
+    wait_queue_init(&sem->waiters);
+
+    return SEM_OK;
+}
+
+
+int32_t semaphore_take(semaphore_t *sem, uint32_t timeout_ticks) {
+    if (sem == NULL) {
+        return SEM_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (sem->count > 0) {
+        sem->count--;
+        exit_critical_basepri(stat);
+        return SEM_OK;
+    }
+
+    if (timeout_ticks == 0) {
+        exit_critical_basepri(stat);
+        return SEM_ERR_TIMEOUT;
+    }
+
+    if (in_isr() || task_current == NULL) {
+        exit_critical_basepri(stat);
+        return SEM_ERR_ISR;
+    }
+
+    /* semaphore_give() hands the count over directly, so WAIT_OK means we own it */
+    int32_t result = task_wait(&sem->waiters, timeout_ticks, stat);
+
+    if (result == WAIT_OK) {
+        return SEM_OK;
+    }
+    return (result == WAIT_TIMEOUT) ? SEM_ERR_TIMEOUT : SEM_ERR_ABORTED;
+}
+
+
+int32_t semaphore_give(semaphore_t *sem) {
+    if (sem == NULL) {
+        return SEM_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    /* A waiter gets the unit directly; the count only grows when nobody waits */
+    if (wait_queue_wake_one(&sem->waiters, WAIT_OK) == NULL) {
+        if (sem->count >= sem->max_count) {
+            exit_critical_basepri(stat);
+            return SEM_ERR_OVERFLOW;
+        }
+        sem->count++;
+    }
+
+    exit_critical_basepri(stat);
+
+    return SEM_OK;
+}
+
+
+uint32_t semaphore_get_count(const semaphore_t *sem) {
+    return (sem != NULL) ? sem->count : 0;
+}
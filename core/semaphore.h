@@ -0,0 +1,78 @@
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Counting and binary semaphores
+ * ==============================
+ * take blocks on the semaphore's wait queue (TASK_BLOCKED, no polling) until
+ * a give arrives or the timeout expires. give never blocks and is safe from
+ * ISRs at or below MAX_SYSCALL_PRIORITY: it hands the count straight to the
+ * highest-priority waiter and pends PendSV if that waiter outranks the
+ * running task, so the switch happens as the ISR returns.
+ *
+ * A binary semaphore is a counting semaphore with max_count 1.
+ */
+
+typedef enum sem_status {
+    SEM_OK            = 0,
+    SEM_ERR_TIMEOUT   = -1,   /* Count still 0 when the timeout expired */
+    SEM_ERR_PARAM     = -2,   /* NULL semaphore or max_count 0 */
+    SEM_ERR_OVERFLOW  = -3,   /* give while already at max_count */
+    SEM_ERR_ISR       = -4,   /* Blocking take from an interrupt handler */
+    SEM_ERR_ABORTED   = -5    /* Wait cut short by task_unblock() */
+} sem_status_t;
+
+typedef struct semaphore {
+    uint32_t     count;
+    uint32_t     max_count;
+    wait_queue_t waiters;
+} semaphore_t;
+
+
+/**
+ * @brief Initialize a semaphore.
+ * 
+ * @param sem Semaphore to initialize
+ * @param initial_count Starting count (clamped to max_count)
+ * @param max_count Upper bound, 1 for a binary semaphore
+ * @return SEM_OK or SEM_ERR_PARAM
+ */
+int32_t semaphore_init(semaphore_t *sem, uint32_t initial_count, uint32_t max_count);
+
+
+/**
+ * @brief Decrement the count, blocking while it is 0.
+ * 
+ * From an ISR only timeout_ticks = 0 (poll) is allowed.
+ * 
+ * @param timeout_ticks SysTick ticks to wait, 0 to not wait, WAIT_FOREVER to block
+ * @return SEM_OK or a negative sem_status_t
+ */
+int32_t semaphore_take(semaphore_t *sem, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Increment the count or release a waiter. Task or ISR context.
+ * 
+ * @return SEM_OK, or SEM_ERR_OVERFLOW if the count is already max_count
+ */
+int32_t semaphore_give(semaphore_t *sem);
+
+
+/**
+ * @brief Current count (0 while tasks are waiting).
+ */
+uint32_t semaphore_get_count(const semaphore_t *sem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMAPHORE_H */
@@ -0,0 +1,204 @@
+#include <stddef.h>
+#include "soft_timer.h"
+#include "scheduler.h"
+#include "systick.h"
+#include "project_config.h"
+#include "utils.h"
+
+/* Active timers, sorted by expiry (earliest first) */
+static soft_timer_t *timer_list_daemon = NULL;
+static soft_timer_t *timer_list_isr = NULL;
+
+static task_handle_t timer_task_handle = TASK_HANDLE_INVALID;
+
+
+/* Wrap-safe "a expires before or together with b" */
+static uint8_t tick_before_eq(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) <= 0;
+}
+
+
+static soft_timer_t **timer_list_for(const soft_timer_t *timer) {
+    return (timer->flags & SOFT_TIMER_ISR_CONTEXT) ? &timer_list_isr : &timer_list_daemon;
+}
+
+
+/* Sorted insert, after timers with the same expiry. Caller holds the critical section. */
+static void timer_insert(soft_timer_t *timer) {
+    soft_timer_t **link = timer_list_for(timer);
+
+    while (*link != NULL && tick_before_eq((*link)->expiry_tick, timer->expiry_tick)) {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    *link = timer;
+    timer->active = 1;
+}
+
+
+/* Caller holds the critical section */
+static void timer_remove(soft_timer_t *timer) {
+    if (!timer->active) {
+        return;
+    }
+
+    soft_timer_t **link = timer_list_for(timer);
+
+    while (*link != NULL && *link != timer) {
+        link = &(*link)->next;
+    }
+    if (*link == timer) {
+        *link = timer->next;
+    }
+
+    timer->next = NULL;
+    timer->active = 0;
+}
+
+
+/*
+ * Unlink the head of a list if it is due, re-arming periodic timers.
+ * Returns the timer whose callback should run, or NULL.
+ */
+static soft_timer_t *timer_pop_due(soft_timer_t **list, soft_timer_callback_t *callback, void **arg) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    uint32_t now = systick_ticks;
+    soft_timer_t *timer = *list;
+
+    if (timer == NULL || !tick_before_eq(timer->expiry_tick, now)) {
+        exit_critical_basepri(stat);
+        return NULL;
+    }
+
+    *list = timer->next;
+    timer->next = NULL;
+    timer->active = 0;
+
+    if (timer->flags & SOFT_TIMER_PERIODIC) {
+        timer->expiry_tick += timer->period_ticks;
+        if (tick_before_eq(timer->expiry_tick, now)) {
+            /* A full period behind: skip the missed expiries */
+            timer->expiry_tick = now + timer->period_ticks;
+        }
+        timer_insert(timer);
+    }
+
+    /* Copy out so the callback runs with what was armed, even if it is reconfigured meanwhile */
+    *callback = timer->callback;
+    *arg = timer->arg;
+
+    exit_critical_basepri(stat);
+    return timer;
+}
+
+
+static void timer_run_due(soft_timer_t **list) {
+    soft_timer_callback_t callback;
+    void *arg;
+
+    while (timer_pop_due(list, &callback, &arg) != NULL) {
+        callback(arg);
+    }
+}
+
+
+static void soft_timer_task(void *arg) {
+    (void)arg;
+
+    while (1) {
+        task_notify_wait(0xFFFFFFFFu, NULL, WAIT_FOREVER);
+        timer_run_due(&timer_list_daemon);
+    }
+}
+
+
+int32_t soft_timer_service_init(void) {
+    int32_t handle = task_create(soft_timer_task, NULL, SOFT_TIMER_TASK_STACK);
+    if (handle < 0) {
+        return -1;
+    }
+
+    timer_task_handle = (task_handle_t)handle;
+    task_set_priority(timer_task_handle, SOFT_TIMER_TASK_PRIORITY);
+    return 0;
+}
+
+
+int32_t soft_timer_init(soft_timer_t *timer, const char *name, soft_timer_callback_t callback,
+                        void *arg, uint32_t period_ticks, uint8_t flags) {
+    if (timer == NULL || callback == NULL || period_ticks == 0) {
+        return -1;
+    }
+
+    timer->name = name;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->period_ticks = period_ticks;
+    timer->expiry_tick = 0;
+    timer->flags = flags & (SOFT_TIMER_PERIODIC | SOFT_TIMER_ISR_CONTEXT);
+    timer->active = 0;
+    timer->next = NULL;
+    return 0;
+}
+
+
+int32_t soft_timer_start(soft_timer_t *timer) {
+    if (timer == NULL) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    timer_remove(timer);
+    timer->expiry_tick = systick_ticks + timer->period_ticks;
+    timer_insert(timer);
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+
+
+void soft_timer_stop(soft_timer_t *timer) {
+    if (timer == NULL) {
+        return;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    timer_remove(timer);
+    exit_critical_basepri(stat);
+}
+
+
+int32_t soft_timer_change_period(soft_timer_t *timer, uint32_t period_ticks) {
+    if (timer == NULL || period_ticks == 0) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    timer->period_ticks = period_ticks;
+    if (timer->active) {
+        timer_remove(timer);
+        timer->expiry_tick = systick_ticks + period_ticks;
+        timer_insert(timer);
+    }
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+
+
+uint8_t soft_timer_is_active(const soft_timer_t *timer) {
+    return (timer != NULL) ? timer->active : 0;
+}
+
+
+void soft_timer_tick(void) {
+    timer_run_due(&timer_list_isr);
+
+    /* Only the list head needs checking; the daemon drains everything that is due */
+    soft_timer_t *head = timer_list_daemon;
+    if (head != NULL && tick_before_eq(head->expiry_tick, systick_ticks)) {
+        task_notify(timer_task_handle, 0, NOTIFY_INCREMENT);
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef SOFT_TIMER_H
+#define SOFT_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Software timers
+ * ===============
+ * One-shot and periodic callbacks driven by SysTick. Active timers are kept
+ * in two lists sorted by expiry tick, so the tick only has to look at the
+ * head of each:
+ *
+ *  - Daemon timers (default): when the head is due, SysTick notifies the
+ *    timer task, which runs every due callback on its own stack. Callbacks
+ *    may block briefly (mutex, queue send) but delay every other timer.
+ *  - SOFT_TIMER_ISR_CONTEXT timers: the callback runs inside SysTick_Handler.
+ *    It must be short and may only use the ISR-safe kernel calls.
+ *
+ * Periodic timers are re-armed from their previous expiry rather than from
+ * the time the callback ran, so they do not drift. A timer that falls a whole
+ * period behind skips the missed expiries instead of firing back to back.
+ *
+ * All calls are safe from tasks and from ISRs at or below MAX_SYSCALL_PRIORITY,
+ * including from inside a timer callback.
+ */
+
+/* soft_timer_init() flags */
+#define SOFT_TIMER_ONE_SHOT       0x00u
+#define SOFT_TIMER_PERIODIC       0x01u   /* Re-arm after every expiry */
+#define SOFT_TIMER_ISR_CONTEXT    0x02u   /* Run the callback in SysTick, not the daemon */
+
+typedef void (*soft_timer_callback_t)(void *arg);
+
+typedef struct soft_timer {
+    const char            *name;
+    soft_timer_callback_t  callback;
+    void                  *arg;
+    uint32_t               period_ticks;
+    uint32_t               expiry_tick;    /* Valid while active */
+    uint8_t                flags;
+    uint8_t                active;
+    struct soft_timer     *next;           /* Active list link */
+} soft_timer_t;
+
+
+/**
+ * @brief Create the timer daemon task. Call once before scheduler_start().
+ *
+ * @return 0 on success, -1 if the task could not be created
+ */
+int32_t soft_timer_service_init(void);
+
+
+/**
+ * @brief Initialize a stopped timer. The structure must outlive any use of it.
+ *
+ * @param name Label for debugging (may be NULL)
+ * @param period_ticks Delay for one-shot timers, period for periodic ones (non-zero)
+ * @param flags SOFT_TIMER_ONE_SHOT or SOFT_TIMER_PERIODIC, optionally | SOFT_TIMER_ISR_CONTEXT
+ * @return 0 on success, -1 on bad parameters
+ */
+int32_t soft_timer_init(soft_timer_t *timer, const char *name, soft_timer_callback_t callback,
+                        void *arg, uint32_t period_ticks, uint8_t flags);
+
+
+/**
+ * @brief Arm the timer to expire period_ticks from now. Restarts it if already active.
+ *
+ * @return 0 on success, -1 on NULL timer
+ */
+int32_t soft_timer_start(soft_timer_t *timer);
+
+
+/**
+ * @brief Disarm the timer. Stopping an inactive timer is a no-op.
+ *
+ * A daemon callback that is already running is not interrupted.
+ */
+void soft_timer_stop(soft_timer_t *timer);
+
+
+/**
+ * @brief Change the period. An active timer restarts with the new period from now.
+ *
+ * @return 0 on success, -1 on NULL timer or zero period
+ */
+int32_t soft_timer_change_period(soft_timer_t *timer, uint32_t period_ticks);
+
+
+/**
+ * @brief Non-zero while the timer is armed.
+ */
+uint8_t soft_timer_is_active(const soft_timer_t *timer);
+
+
+/**
+ * @brief Expire due timers. Called from SysTick_Handler on every tick.
+ */
+void soft_timer_tick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOFT_TIMER_H */
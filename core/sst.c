@@ -0,0 +1,158 @@
+#include <stddef.h>
+#include "sst.h"
+#include "project_config.h"
+#include "device_registers.h"
+#include "utils.h"
+#include "trace.h"
+
+/* Interrupt line of each level, lowest level first */
+static const uint8_t sst_irqn[4] = { SAI1_IRQn, SAI2_IRQn, SWPMI1_IRQn, TSC_IRQn };
+
+static sst_task_t *sst_tasks[SST_PRIORITY_LEVELS];
+
+
+static uint32_t sst_nvic_priority(uint8_t level) {
+    return SST_NVIC_PRIORITY_LOWEST - (level - 1u);
+}
+
+
+/* Drain the level's queue; a post from a higher level preempts between events */
+static void sst_dispatch(uint8_t level) {
+    sst_task_t *task = sst_tasks[level - 1u];
+    if (task == NULL) {
+        return;
+    }
+
+    TRACE_ISR_ENTER();
+    while (1) {
+        uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+        if (task->count == 0) {
+            exit_critical_basepri(stat);
+            TRACE_ISR_EXIT();
+            return;
+        }
+        uint32_t event = task->queue[task->head];
+        task->head = (uint8_t)((task->head + 1u) % task->capacity);
+        task->count--;
+        exit_critical_basepri(stat);
+
+        task->handler(task, event);
+        task->dispatched++;
+    }
+}
+
+
+void SAI1_IRQHandler(void) {
+    sst_dispatch(1);
+}
+
+
+#if SST_PRIORITY_LEVELS >= 2
+void SAI2_IRQHandler(void) {
+    sst_dispatch(2);
+}
+#endif
+
+
+#if SST_PRIORITY_LEVELS >= 3
+void SWPMI1_IRQHandler(void) {
+    sst_dispatch(3);
+}
+#endif
+
+
+#if SST_PRIORITY_LEVELS >= 4
+void TSC_IRQHandler(void) {
+    sst_dispatch(4);
+}
+#endif
+
+
+int32_t sst_task_init(sst_task_t *task, const char *name, sst_handler_t handler,
+                      uint32_t *queue, uint8_t capacity, uint8_t level) {
+    if (task == NULL || handler == NULL || queue == NULL || capacity == 0 ||
+        level < 1 || level > SST_PRIORITY_LEVELS) {
+        return SST_ERR_PARAM;
+    }
+    if (sst_tasks[level - 1u] != NULL) {
+        return SST_ERR_BUSY;
+    }
+
+    task->name = name;
+    task->handler = handler;
+    task->queue = queue;
+    task->capacity = capacity;
+    task->head = 0;
+    task->count = 0;
+    task->level = level;
+    task->dispatched = 0;
+    task->overflows = 0;
+    task->max_count = 0;
+
+    sst_tasks[level - 1u] = task;
+
+    uint8_t irqn = sst_irqn[level - 1u];
+    nvic_set_priority(irqn, sst_nvic_priority(level));
+    nvic_enable_irq(irqn);
+
+    return SST_OK;
+}
+
+
+int32_t sst_post(sst_task_t *task, uint32_t event) {
+    if (task == NULL || task->queue == NULL) {
+        return SST_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (task->count >= task->capacity) {
+        task->overflows++;
+        exit_critical_basepri(stat);
+        return SST_ERR_FULL;
+    }
+
+    uint8_t tail = (uint8_t)((task->head + task->count) % task->capacity);
+    task->queue[tail] = event;
+    task->count++;
+    if (task->count > task->max_count) {
+        task->max_count = task->count;
+    }
+
+    /* Pended inside the critical section; the handler runs once BASEPRI drops */
+    nvic_set_pending(sst_irqn[task->level - 1u]);
+
+    exit_critical_basepri(stat);
+    return SST_OK;
+}
+
+
+uint32_t sst_lock(uint8_t ceiling) {
+    if (ceiling < 1) {
+        ceiling = 1;
+    } else if (ceiling > SST_PRIORITY_LEVELS) {
+        ceiling = SST_PRIORITY_LEVELS;
+    }
+
+    uint32_t basepri = sst_nvic_priority(ceiling) << (8 - NVIC_PRIO_BITS);
+    uint32_t old;
+    __asm volatile (
+        "MRS %0, BASEPRI\n"
+        "MSR BASEPRI_MAX, %1\n"     /* Only ever raises the mask */
+        : "=r"(old) : "r"(basepri) : "memory"
+    );
+    return old;
+}
+
+
+void sst_unlock(uint32_t key) {
+    exit_critical_basepri(key);
+}
+
+
+sst_task_t *sst_task_at(uint8_t level) {
+    if (level < 1 || level > SST_PRIORITY_LEVELS) {
+        return NULL;
+    }
+    return sst_tasks[level - 1u];
+}
@@ -0,0 +1,105 @@
+#ifndef SST_H
+#define SST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Run-to-completion tasks (Super Simple Tasker style)
+ * ===================================================
+ * An SST task is an event handler that never blocks: it is called once per
+ * posted event and returns. Each priority level is bound to an otherwise
+ * unused interrupt line, and sst_post() queues the event and pends that
+ * line, so the NVIC does the scheduling: a higher level preempts a lower
+ * one, and every level preempts all blocking (PSP) tasks. Handlers run on
+ * the main stack like any ISR, so the RAM cost grows with the number of
+ * levels that can nest, not with the number of tasks.
+ *
+ * Handlers may use the ISR-safe kernel calls (task_notify, semaphore_give,
+ * queue_send_from_isr, workqueue_submit, sst_post ...) but never anything
+ * that waits. Data shared between levels is protected with sst_lock(),
+ * which masks only the levels up to a ceiling.
+ *
+ *      level 4  TSC     NVIC SST_NVIC_PRIORITY_LOWEST - 3
+ *      level 3  SWPMI1  NVIC SST_NVIC_PRIORITY_LOWEST - 2
+ *      level 2  SAI2    NVIC SST_NVIC_PRIORITY_LOWEST - 1
+ *      level 1  SAI1    NVIC SST_NVIC_PRIORITY_LOWEST
+ */
+
+typedef enum sst_status {
+    SST_OK          = 0,
+    SST_ERR_FULL    = -1,   /* Event queue full; the event was dropped */
+    SST_ERR_PARAM   = -2,   /* NULL task/handler/queue or level out of range */
+    SST_ERR_BUSY    = -3    /* Another task already owns the level */
+} sst_status_t;
+
+struct sst_task;
+typedef void (*sst_handler_t)(struct sst_task *self, uint32_t event);
+
+typedef struct sst_task {
+    const char    *name;
+    sst_handler_t  handler;
+    uint32_t      *queue;           /* Event ring, storage from the caller */
+    uint8_t        capacity;
+    uint8_t        head;            /* Next event to dispatch */
+    uint8_t        count;
+    uint8_t        level;           /* 1 .. SST_PRIORITY_LEVELS */
+    uint32_t       dispatched;      /* Events handled */
+    uint32_t       overflows;       /* Posts refused because the queue was full */
+    uint8_t        max_count;       /* Queue high-water mark */
+} sst_task_t;
+
+
+/**
+ * @brief Bind a task to a priority level and enable its interrupt line.
+ *
+ * @param queue Storage for up to capacity pending events
+ * @param level 1 (lowest) .. SST_PRIORITY_LEVELS; one task per level
+ * @return SST_OK or a negative sst_status_t
+ */
+int32_t sst_task_init(sst_task_t *task, const char *name, sst_handler_t handler,
+                      uint32_t *queue, uint8_t capacity, uint8_t level);
+
+
+/**
+ * @brief Queue an event and activate the task. Safe from tasks, ISRs and
+ * other SST handlers at or below MAX_SYSCALL_PRIORITY.
+ *
+ * Posting to a higher level than the caller's runs the handler before this
+ * returns; posting to the same or a lower level runs it afterwards.
+ *
+ * @return SST_OK, SST_ERR_FULL or SST_ERR_PARAM
+ */
+int32_t sst_post(sst_task_t *task, uint32_t event);
+
+
+/**
+ * @brief Mask SST levels up to and including ceiling (priority ceiling lock).
+ *
+ * Never lowers the current mask, so it nests inside kernel critical
+ * sections and other locks.
+ *
+ * @return Previous mask, for sst_unlock()
+ */
+uint32_t sst_lock(uint8_t ceiling);
+
+
+/**
+ * @brief Restore the mask saved by sst_lock().
+ */
+void sst_unlock(uint32_t key);
+
+
+/**
+ * @brief Task bound to a level, or NULL.
+ */
+sst_task_t *sst_task_at(uint8_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SST_H */
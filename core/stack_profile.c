@@ -0,0 +1,185 @@
+#include <stddef.h>
+#include <string.h>
+#include "stack_profile.h"
+#include "scheduler.h"
+#include "soft_timer.h"
+#include "utils.h"
+
+#if STACK_PROFILE
+
+extern uint32_t _etext;     /* Linker script: end of code, moves with almost any change */
+
+/* Survives resets; see .noinit in the linker script */
+static stack_profile_table_t stack_profile __attribute__((section(".noinit")));
+
+/* Entries already counted in this run (not persistent) */
+static uint8_t stack_profile_seen[STACK_PROFILE_ENTRIES];
+static soft_timer_t stack_profile_timer;
+
+
+static uint32_t stack_profile_sum(const stack_profile_table_t *table) {
+    return noinit_checksum(table, offsetof(stack_profile_table_t, checksum));
+}
+
+
+/* Start an empty table for this build. Caller holds the critical section. */
+static void stack_profile_reset(uint32_t runs) {
+    memset(&stack_profile, 0, sizeof(stack_profile));
+    memset(stack_profile_seen, 0, sizeof(stack_profile_seen));
+    stack_profile.magic = STACK_PROFILE_MAGIC;
+    stack_profile.build = (uint32_t)&_etext;
+    stack_profile.runs = runs;
+    stack_profile.checksum = stack_profile_sum(&stack_profile);
+}
+
+
+/*
+ * Merge one sample: 1 if the table changed, 0 if not, -1 if the table is full.
+ * Caller holds the critical section.
+ */
+static int32_t stack_profile_merge(uint32_t entry, uint32_t size, uint32_t peak) {
+    stack_profile_entry_t *free_slot = NULL;
+
+    for (uint32_t i = 0; i < STACK_PROFILE_ENTRIES; ++i) {
+        stack_profile_entry_t *e = &stack_profile.entries[i];
+        if (e->entry == 0) {
+            if (free_slot == NULL) {
+                free_slot = e;
+            }
+            continue;
+        }
+        if (e->entry != entry || e->size != size) {
+            continue;
+        }
+
+        int32_t changed = 0;
+        if (!stack_profile_seen[i]) {
+            stack_profile_seen[i] = 1;
+            e->runs++;
+            changed = 1;
+        }
+        if (peak > e->peak) {
+            e->peak = peak;
+            changed = 1;
+        }
+        return changed;
+    }
+
+    if (free_slot == NULL) {
+        return -1;
+    }
+
+    free_slot->entry = entry;
+    free_slot->size = size;
+    free_slot->peak = peak;
+    free_slot->runs = 1;
+    stack_profile_seen[free_slot - stack_profile.entries] = 1;
+    return 1;
+}
+
+
+static void stack_profile_timer_cb(void *arg) {
+    (void)arg;
+    stack_profile_sample();
+}
+
+
+void stack_profile_init(void) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    if (stack_profile.magic == STACK_PROFILE_MAGIC &&
+        stack_profile.checksum == stack_profile_sum(&stack_profile) &&
+        stack_profile.build == (uint32_t)&_etext) {
+        stack_profile.runs++;
+        stack_profile.checksum = stack_profile_sum(&stack_profile);
+    } else {
+        stack_profile_reset(1);     /* Power-on garbage or another build's peaks */
+    }
+
+    exit_critical_basepri(stat);
+
+    soft_timer_init(&stack_profile_timer, "stackprof", stack_profile_timer_cb, NULL,
+                    STACK_PROFILE_SAMPLE_TICKS, SOFT_TIMER_PERIODIC);
+    soft_timer_start(&stack_profile_timer);
+}
+
+
+void stack_profile_sample(void) {
+    uint32_t missed = 0;
+
+    for (uint32_t i = 0; i < MAX_TASKS; ++i) {
+        task_t *task = &task_list[i];
+        if (task->state == TASK_UNUSED || task->state == TASK_ZOMBIE) {
+            continue;
+        }
+
+        /* Copy the key first: the slot may be reused before the scan */
+        task_handle_t handle = task->handle;
+        uint32_t entry = (uint32_t)task->entry & ~1u;   /* Thumb bit off, as in the map file */
+
+        task_stack_info_t info;
+        if (entry == 0 || task_get_stack_info(handle, &info) != 0) {
+            continue;
+        }
+
+        uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+        if (task->handle == handle) {
+            int32_t result = stack_profile_merge(entry, info.size, info.peak);
+            if (result > 0) {
+                stack_profile.checksum = stack_profile_sum(&stack_profile);
+            } else if (result < 0) {
+                missed++;
+            }
+        }
+        exit_critical_basepri(stat);
+    }
+
+    /* Most call sites left out by any one pass */
+    if (missed > stack_profile.dropped) {
+        uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+        stack_profile.dropped = missed;
+        stack_profile.checksum = stack_profile_sum(&stack_profile);
+        exit_critical_basepri(stat);
+    }
+}
+
+
+int32_t stack_profile_get(uint32_t index, stack_profile_entry_t *entry) {
+    if (index >= STACK_PROFILE_ENTRIES || entry == NULL) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    *entry = stack_profile.entries[index];
+    exit_critical_basepri(stat);
+
+    return (entry->entry != 0) ? 0 : -1;
+}
+
+
+uint32_t stack_profile_runs(void) {
+    return stack_profile.runs;
+}
+
+
+uint32_t stack_profile_dropped(void) {
+    return stack_profile.dropped;
+}
+
+
+uint32_t stack_profile_recommend(uint32_t peak) {
+    /* Peak excludes the canary word at the bottom */
+    uint32_t need = peak + sizeof(uint32_t);
+    need += need * STACK_PROFILE_MARGIN_PCT / 100u;
+    need = (need + 7u) & ~7u;
+    return (need < STACK_MIN_SIZE_BYTES) ? STACK_MIN_SIZE_BYTES : need;
+}
+
+
+void stack_profile_clear(void) {
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    stack_profile_reset(1);
+    exit_critical_basepri(stat);
+}
+
+#endif /* STACK_PROFILE */
@@ -0,0 +1,96 @@
+#ifndef STACK_PROFILE_H
+#define STACK_PROFILE_H
+
+#include <stdint.h>
+#include "project_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Stack right-sizing
+ * ==================
+ * A timer-daemon job folds every live task's stack peak (the STACK_WATERMARK
+ * scan) into a table kept in .noinit RAM, so the worst case seen survives
+ * resets and accumulates over several runs of the same firmware. Tasks are
+ * told apart by entry function and stack size, i.e. by task_create() call
+ * site. A new build (different end of .text) or a power cycle starts over.
+ *
+ * 'stackfit' turns the table into a recommended size per task: peak plus
+ * the canary word, plus STACK_PROFILE_MARGIN_PCT, rounded to 8 bytes and no
+ * smaller than STACK_MIN_SIZE_BYTES. The entry address is looked up in the
+ * map file to find the call site.
+ */
+
+#define STACK_PROFILE_MAGIC     0x46505453u     /* "STPF" */
+
+/* One task_create() call site */
+typedef struct stack_profile_entry {
+    uint32_t entry;         /* Task entry function (0 = free) */
+    uint32_t size;          /* Usable stack bytes, as task_get_stack_info() reports */
+    uint32_t peak;          /* Deepest use seen over all runs */
+    uint32_t runs;          /* Runs in which the task was sampled */
+} stack_profile_entry_t;
+
+/* Persistent table, kept in .noinit RAM */
+typedef struct stack_profile_table {
+    uint32_t magic;         /* STACK_PROFILE_MAGIC when valid */
+    uint32_t build;         /* Firmware fingerprint the peaks belong to */
+    uint32_t runs;          /* Boots folded into the table */
+    uint32_t dropped;       /* Most call sites one pass found no room for */
+    stack_profile_entry_t entries[STACK_PROFILE_ENTRIES];
+    uint32_t checksum;
+} stack_profile_table_t;
+
+
+/**
+ * @brief Validate the table left by the last run (or start a new one) and
+ * start the sampler. Call once after soft_timer_service_init().
+ */
+void stack_profile_init(void);
+
+
+/**
+ * @brief Fold the current peaks of all live tasks into the table now.
+ * Task context only; scans every stack.
+ */
+void stack_profile_sample(void);
+
+
+/**
+ * @brief Copy out entry 'index'.
+ *
+ * @return 0 on success, -1 for a free slot or an index past the table
+ */
+int32_t stack_profile_get(uint32_t index, stack_profile_entry_t *entry);
+
+
+/**
+ * @brief Boots folded into the table, including this one.
+ */
+uint32_t stack_profile_runs(void);
+
+
+/**
+ * @brief Most live call sites a single pass could not record (table full).
+ */
+uint32_t stack_profile_dropped(void);
+
+
+/**
+ * @brief Stack size to ask for given an observed peak, in bytes.
+ */
+uint32_t stack_profile_recommend(uint32_t peak);
+
+
+/**
+ * @brief Forget all recorded peaks (e.g. after resizing stacks).
+ */
+void stack_profile_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STACK_PROFILE_H */
@@ -1,7 +1,7 @@
 #include "utils.h"
 #include "stm32_alloc.h"
 
-#define ALLOCATOR_PRIORITY_THRESHOLD 0x50
+#define ALLOCATOR_PRIORITY_THRESHOLD MAX_SYSCALL_BASEPRI
 
 void  stm32_allocator_init(uint8_t* pool, size_t size) {
     uint32_t status = enter_critical_basepri(ALLOCATOR_PRIORITY_THRESHOLD);
@@ -0,0 +1,115 @@
+#include "trace.h"
+#include "scheduler.h"
+#include "system_clock.h"
+#include "dwt.h"
+#include "utils.h"
+
+#if KERNEL_TRACE
+
+static trace_record_t trace_buffer[TRACE_BUFFER_RECORDS];
+static volatile uint32_t trace_head = 0;     /* Records claimed since the last clear */
+static volatile uint8_t trace_enabled = 1;
+
+
+void trace_record(uint8_t event, uint8_t task, uint16_t arg) {
+    if (!trace_enabled) {
+        return;
+    }
+
+    /* Claim, then fill: a nested writer simply takes the next slot */
+    uint32_t pos = __atomic_fetch_add(&trace_head, 1u, __ATOMIC_RELAXED);
+    trace_record_t *record = &trace_buffer[pos & (TRACE_BUFFER_RECORDS - 1u)];
+
+    record->cycles = dwt_get_cycles();
+    record->event = event;
+    record->task = task;
+    record->arg = arg;
+}
+
+
+uint8_t trace_task_id(const struct task_struct *task) {
+    if (task == NULL) {
+        return TRACE_NO_TASK;
+    }
+    return (uint8_t)(task - task_list);
+}
+
+
+void trace_record_current(uint8_t event, uint16_t arg) {
+    trace_record(event, trace_task_id(task_current), arg);
+}
+
+
+void trace_isr_enter(void) {
+    trace_record_current(TRACE_ISR_ENTER, (uint16_t)in_isr());
+}
+
+
+void trace_isr_exit(void) {
+    trace_record_current(TRACE_ISR_EXIT, (uint16_t)in_isr());
+}
+
+
+void trace_set_enabled(uint8_t enabled) {
+    trace_enabled = (enabled != 0);
+}
+
+
+uint8_t trace_is_enabled(void) {
+    return trace_enabled;
+}
+
+
+void trace_clear(void) {
+    uint8_t was_enabled = trace_enabled;
+    trace_enabled = 0;
+    trace_head = 0;
+    trace_enabled = was_enabled;
+}
+
+
+uint32_t trace_total(void) {
+    return trace_head;
+}
+
+
+int32_t trace_dump(trace_write_fn_t write) {
+    if (write == NULL) {
+        return -1;
+    }
+
+    uint8_t was_enabled = trace_enabled;
+    trace_enabled = 0;
+
+    uint32_t head = trace_head;
+    uint32_t count = (head < TRACE_BUFFER_RECORDS) ? head : TRACE_BUFFER_RECORDS;
+
+    trace_dump_header_t header = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .record_size = (uint8_t)sizeof(trace_record_t),
+        .reserved = 0,
+        .cpu_hz = get_system_clock_hz(),
+        .count = count,
+        .lost = head - count,
+    };
+
+    int32_t status = (int32_t)count;
+    if (write(&header, sizeof(header)) != (int)sizeof(header)) {
+        status = -1;
+    }
+
+    /* Oldest record first; the ring may have wrapped at head */
+    uint32_t first = head - count;
+    for (uint32_t i = 0; i < count && status >= 0; ++i) {
+        const trace_record_t *record = &trace_buffer[(first + i) & (TRACE_BUFFER_RECORDS - 1u)];
+        if (write(record, sizeof(*record)) != (int)sizeof(*record)) {
+            status = -1;
+        }
+    }
+
+    trace_enabled = was_enabled;
+    return status;
+}
+
+#endif /* KERNEL_TRACE */
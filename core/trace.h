@@ -0,0 +1,151 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "project_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Kernel event trace
+ * ==================
+ * A ring of fixed 8-byte records (DWT timestamp, event, task slot, argument)
+ * fed from the scheduler, the tick, the allocator and instrumented ISRs.
+ * Writers claim a slot with one atomic increment and never mask interrupts;
+ * when the ring is full the oldest records are overwritten.
+ *
+ * 'trace dump' pauses recording and streams the ring as binary: a
+ * trace_dump_header_t followed by 'count' records, oldest first, all little
+ * endian. scripts/trace2chrome.py turns a capture of that into Chrome trace
+ * JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * With KERNEL_TRACE 0, or in host builds, the hooks compile to nothing.
+ */
+
+typedef enum trace_event {
+    TRACE_SWITCH = 1,       /* task = incoming, arg = outgoing slot */
+    TRACE_SLEEP,            /* Sleep or EDF period wait; arg = ticks (saturated) */
+    TRACE_WAKE,             /* Sleep or wait ended; arg = wait_result_t (as uint16) */
+    TRACE_BLOCK,            /* Wait queue, notify wait or task_block; arg = timeout, 0xFFFF forever */
+    TRACE_UNBLOCK,          /* task_unblock() */
+    TRACE_ISR_ENTER,        /* task = interrupted task, arg = exception number */
+    TRACE_ISR_EXIT,
+    TRACE_MALLOC,           /* arg = requested bytes (saturated) */
+    TRACE_MALLOC_FAIL,
+    TRACE_FREE,             /* arg = block bytes (saturated) */
+    TRACE_EVENT_COUNT
+} trace_event_t;
+
+#define TRACE_NO_TASK       0xFFu   /* Record made before the scheduler started */
+#define TRACE_MAGIC         0x4352544Bu  /* "KTRC" */
+#define TRACE_VERSION       1u
+
+typedef struct trace_record {
+    uint32_t cycles;        /* DWT cycle counter */
+    uint8_t  event;         /* trace_event_t */
+    uint8_t  task;          /* Task slot index, or TRACE_NO_TASK */
+    uint16_t arg;
+} trace_record_t;
+
+typedef struct trace_dump_header {
+    uint32_t magic;         /* TRACE_MAGIC */
+    uint8_t  version;       /* TRACE_VERSION */
+    uint8_t  record_size;   /* sizeof(trace_record_t) */
+    uint16_t reserved;
+    uint32_t cpu_hz;        /* Cycle counter frequency */
+    uint32_t count;         /* Records that follow */
+    uint32_t lost;          /* Older records overwritten since the last clear */
+} trace_dump_header_t;
+
+/* Raw output for trace_dump(); returns the number of bytes accepted */
+typedef int (*trace_write_fn_t)(const void *data, uint32_t len);
+
+
+#if KERNEL_TRACE && !defined(UNIT_TESTING)
+
+struct task_struct;
+
+/**
+ * @brief Append one record. Any context at or below MAX_SYSCALL_PRIORITY.
+ */
+void trace_record(uint8_t event, uint8_t task, uint16_t arg);
+
+
+/**
+ * @brief Append a record for the running task.
+ */
+void trace_record_current(uint8_t event, uint16_t arg);
+
+
+/**
+ * @brief Slot index of a task as stored in records.
+ */
+uint8_t trace_task_id(const struct task_struct *task);
+
+
+/**
+ * @brief Bracket an ISR body; records the active exception number.
+ */
+void trace_isr_enter(void);
+void trace_isr_exit(void);
+
+
+#define TRACE(event, task, arg)     trace_record((event), trace_task_id(task), (uint16_t)(arg))
+#define TRACE_CURRENT(event, arg)   trace_record_current((event), (uint16_t)(arg))
+#define TRACE_ISR_ENTER()           trace_isr_enter()
+#define TRACE_ISR_EXIT()            trace_isr_exit()
+
+#else
+
+#define TRACE(event, task, arg)     ((void)0)
+#define TRACE_CURRENT(event, arg)   ((void)0)
+#define TRACE_ISR_ENTER()           ((void)0)
+#define TRACE_ISR_EXIT()            ((void)0)
+
+#endif /* KERNEL_TRACE && !UNIT_TESTING */
+
+/* Clamp a count into a record's 16-bit argument */
+#define TRACE_ARG_SAT(value)        ((value) > 0xFFFFu ? 0xFFFFu : (uint16_t)(value))
+
+
+/**
+ * @brief Pause (0) or resume (non-zero) recording.
+ */
+void trace_set_enabled(uint8_t enabled);
+
+
+/**
+ * @brief Non-zero while recording.
+ */
+uint8_t trace_is_enabled(void);
+
+
+/**
+ * @brief Drop all records.
+ */
+void trace_clear(void);
+
+
+/**
+ * @brief Records written since the last clear (including overwritten ones).
+ */
+uint32_t trace_total(void);
+
+
+/**
+ * @brief Stream header and records through write, oldest first.
+ *
+ * Recording is paused for the duration and restored afterwards. Must be
+ * called from a task; write may block.
+ *
+ * @return Number of records written, or -1 if write failed
+ */
+int32_t trace_dump(trace_write_fn_t write);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
@@ -76,3 +76,12 @@ int strcmp(const char *s1, const char *s2) {
     }
     return *(const unsigned char *)s1 - *(const unsigned char *)s2;
 }
+
+uint32_t noinit_checksum(const void *data, size_t len) {
+    const uint32_t *word = data;
+    uint32_t sum = 0x5A5A5A5Au;
+    for (size_t i = 0; i < len / sizeof(uint32_t); ++i) {
+        sum = (sum << 1 | sum >> 31) ^ word[i];
+    }
+    return sum;
+}
@@ -10,9 +10,20 @@
 extern "C" {
 #endif
 
+#ifndef NULL
 #define NULL ((void *)0)
+#endif
+
+#ifndef UNIT_TESTING
 #define __WFI()         __asm volatile ("wfi")
 #define KERNEL_NOP()    __asm volatile ("nop")
+#else
+/* Host build (unit tests, benchmarks): there is no core to halt */
+#define __WFI()         do { } while (0)
+#define KERNEL_NOP()    do { } while (0)
+#endif
+
+#ifndef UNIT_TESTING
 
 /**
  * @brief   Data Synchronization Barrier (DSB).
@@ -46,6 +57,16 @@ static inline void __DMB(void) {
 }
 
 
+#else /* UNIT_TESTING */
+
+/* Host build: nothing to order against */
+static inline void __DSB(void) { }
+static inline void __ISB(void) { }
+static inline void __DMB(void) { }
+
+#endif /* UNIT_TESTING */
+
+
 /**
  * @brief   Waits for specific bits in a register to be SET.
  * @param   reg      Pointer to the volatile register to monitor.
@@ -75,6 +96,8 @@ int wait_for_flag_clear(volatile uint32_t *reg, uint32_t mask, uint32_t max_iter
 int wait_for_reg_mask_eq(volatile uint32_t *reg, uint32_t mask, uint32_t expected, uint32_t max_iter);
 
 
+#ifndef UNIT_TESTING
+
 /**
  * @brief   Enter critical section (Global Interrupt Disable).
  * @details Uses the PRIMASK register to disable all configurable interrupts.
@@ -113,7 +136,8 @@ static inline void exit_critical_primask(uint32_t state) {
  * @brief   Enter critical section (Selective Interrupt Masking).
  * @details Uses the BASEPRI register to mask interrupts at or below a specific
  * priority level. Higher priority interrupts remain enabled.
- * @param   new_basepri The priority threshold (e.g., 0x50).
+ * @param   new_basepri The priority threshold (e.g., 0x50), already shifted into
+ * the implemented bits. Kernel code uses MAX_SYSCALL_BASEPRI.
  * 0 disables masking (enables all).
  * @return  The original value of the BASEPRI register.
  */
@@ -140,6 +164,68 @@ static inline void exit_critical_basepri(uint32_t old) {
 }
 
 
+/**
+ * @brief   Check whether the caller runs in handler mode.
+ * @return  Non-zero inside an exception/interrupt handler (IPSR != 0).
+ */
+static inline uint32_t in_isr(void) {
+    uint32_t ipsr;
+    __asm volatile ("MRS %0, IPSR" : "=r"(ipsr));
+    return ipsr;
+}
+
+#else /* UNIT_TESTING */
+
+/* Host build: single-threaded, critical sections are no-ops */
+static inline uint32_t enter_critical_primask(void) { return 0; }
+static inline void exit_critical_primask(uint32_t state) { (void)state; }
+static inline uint32_t enter_critical_basepri(uint32_t new_basepri) { (void)new_basepri; return 0; }
+static inline void exit_critical_basepri(uint32_t old) { (void)old; }
+static inline uint32_t in_isr(void) { return 0; }
+
+#endif /* UNIT_TESTING */
+
+
+/**
+ * @brief   Enable an interrupt line in the NVIC.
+ * @param   irqn Device IRQ number (e.g. USART2_IRQn).
+ */
+static inline void nvic_enable_irq(uint32_t irqn) {
+    NVIC_ISER(irqn >> 5) = (1UL << (irqn & 0x1F));
+}
+
+
+/**
+ * @brief   Disable an interrupt line in the NVIC.
+ * @param   irqn Device IRQ number.
+ */
+static inline void nvic_disable_irq(uint32_t irqn) {
+    NVIC_ICER(irqn >> 5) = (1UL << (irqn & 0x1F));
+    __DSB();
+    __ISB();
+}
+
+
+/**
+ * @brief   Set the priority of an interrupt line.
+ * @param   irqn     Device IRQ number.
+ * @param   priority 0 (highest) .. 15 (lowest). Lines that call kernel
+ *                   functions must use MAX_SYSCALL_PRIORITY or lower urgency.
+ */
+static inline void nvic_set_priority(uint32_t irqn, uint32_t priority) {
+    NVIC_IPR(irqn) = (uint8_t)(priority << (8 - NVIC_PRIO_BITS));
+}
+
+
+/**
+ * @brief   Pend an interrupt line from software.
+ * @param   irqn Device IRQ number.
+ */
+static inline void nvic_set_pending(uint32_t irqn) {
+    NVIC_ISPR(irqn >> 5) = (1UL << (irqn & 0x1F));
+}
+
+
 /**
  * @brief   Trigger a context switch.
  * @details Sets the PendSV (Pendable Service Call) flag. The context switch 
@@ -159,6 +245,12 @@ void *memcpy(void *dest, const void *src, size_t n);
 
 int strcmp(const char *s1, const char *s2);
 
+/**
+ * @brief Rotate-xor checksum over the first len bytes (whole words) of a
+ *        record kept in .noinit across resets.
+ */
+uint32_t noinit_checksum(const void *data, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,199 @@
+#include <stddef.h>
+#include "watchdog.h"
+#include "project_config.h"
+#include "soft_timer.h"
+#include "systick.h"
+#include "iwdg.h"
+#include "utils.h"
+
+#if TASK_WATCHDOG
+
+typedef struct watchdog_slot {
+    const char   *name;             /* NULL when free */
+    task_handle_t handle;
+    uint32_t      timeout_ticks;
+    volatile uint32_t last_checkin;
+    uint32_t      max_gap;
+} watchdog_slot_t;
+
+static watchdog_slot_t watchdog_slots[WATCHDOG_MAX_TASKS];
+static soft_timer_t watchdog_timer;
+static uint8_t watchdog_tripped = 0;
+static uint8_t watchdog_iwdg_reset = 0;
+
+/* Survives the reset it causes; see .noinit in the linker script */
+static watchdog_record_t watchdog_record __attribute__((section(".noinit")));
+
+
+static uint32_t watchdog_record_sum(const watchdog_record_t *record) {
+    return noinit_checksum(record, offsetof(watchdog_record_t, checksum));
+}
+
+
+static uint8_t watchdog_record_valid(void) {
+    return watchdog_record.magic == WATCHDOG_RECORD_MAGIC &&
+           watchdog_record.checksum == watchdog_record_sum(&watchdog_record);
+}
+
+
+/* Note the stalled slot; runs once, the reset follows */
+static void watchdog_record_stall(const watchdog_slot_t *slot, uint32_t silent) {
+    uint32_t stalls = watchdog_record_valid() ? watchdog_record.stalls : 0;
+
+    for (uint32_t i = 0; i < WATCHDOG_NAME_LEN; ++i) {
+        char c = slot->name[i];
+        watchdog_record.name[i] = c;
+        if (c == '\0') {
+            for (; i < WATCHDOG_NAME_LEN; ++i) {
+                watchdog_record.name[i] = '\0';
+            }
+            break;
+        }
+    }
+    watchdog_record.name[WATCHDOG_NAME_LEN - 1] = '\0';
+
+    watchdog_record.handle = slot->handle;
+    watchdog_record.timeout_ticks = slot->timeout_ticks;
+    watchdog_record.silent_ticks = silent;
+    watchdog_record.uptime_ticks = systick_ticks;
+    watchdog_record.stalls = stalls + 1u;
+    watchdog_record.magic = WATCHDOG_RECORD_MAGIC;
+    watchdog_record.checksum = watchdog_record_sum(&watchdog_record);
+}
+
+
+/* Supervisor, from SysTick: kick the IWDG only if every slot is on time */
+static void watchdog_supervise(void *arg) {
+    (void)arg;
+    uint32_t now = systick_ticks;
+
+    for (uint32_t i = 0; i < WATCHDOG_MAX_TASKS && !watchdog_tripped; ++i) {
+        watchdog_slot_t *slot = &watchdog_slots[i];
+        if (slot->name == NULL) {
+            continue;
+        }
+        /* The owner exited or was deleted: nobody is left to check in */
+        if (slot->handle != TASK_HANDLE_INVALID && task_from_handle(slot->handle) == NULL) {
+            slot->name = NULL;
+            continue;
+        }
+        uint32_t silent = now - slot->last_checkin;
+        if (silent > slot->timeout_ticks) {
+            watchdog_record_stall(slot, silent);
+            watchdog_tripped = 1;
+        }
+    }
+
+    if (!watchdog_tripped) {
+        iwdg_kick();
+    }
+}
+
+
+void watchdog_init(void) {
+    watchdog_iwdg_reset = iwdg_take_reset_flag();
+    if (!watchdog_record_valid()) {
+        watchdog_record.magic = 0;  /* Power-on garbage */
+    }
+
+    soft_timer_init(&watchdog_timer, "watchdog", watchdog_supervise, NULL,
+                    WATCHDOG_CHECK_TICKS, SOFT_TIMER_PERIODIC | SOFT_TIMER_ISR_CONTEXT);
+}
+
+
+int32_t watchdog_start(void) {
+    if (iwdg_start(WATCHDOG_IWDG_TIMEOUT_MS) != 0) {
+        return -1;
+    }
+    return soft_timer_start(&watchdog_timer);
+}
+
+
+int32_t watchdog_register(const char *name, uint32_t timeout_ticks) {
+    if (name == NULL || timeout_ticks == 0) {
+        return WATCHDOG_ERR_PARAM;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+
+    for (uint32_t i = 0; i < WATCHDOG_MAX_TASKS; ++i) {
+        watchdog_slot_t *slot = &watchdog_slots[i];
+        if (slot->name == NULL) {
+            /* Before the scheduler runs, or from an ISR, there is no owning task */
+            slot->handle = (task_current != NULL && !in_isr()) ? task_get_current_handle()
+                                                                : TASK_HANDLE_INVALID;
+            slot->timeout_ticks = timeout_ticks;
+            slot->last_checkin = systick_ticks;
+            slot->max_gap = 0;
+            slot->name = name;      /* Last: the supervisor skips free slots */
+            exit_critical_basepri(stat);
+            return (int32_t)i;
+        }
+    }
+
+    exit_critical_basepri(stat);
+    return WATCHDOG_ERR_FULL;
+}
+
+
+int32_t watchdog_unregister(int32_t id) {
+    if (id < 0 || id >= WATCHDOG_MAX_TASKS) {
+        return WATCHDOG_ERR_PARAM;
+    }
+    watchdog_slots[id].name = NULL;
+    return WATCHDOG_OK;
+}
+
+
+void watchdog_checkin(int32_t id) {
+    if (id < 0 || id >= WATCHDOG_MAX_TASKS) {
+        return;
+    }
+
+    watchdog_slot_t *slot = &watchdog_slots[id];
+    uint32_t now = systick_ticks;
+    uint32_t gap = now - slot->last_checkin;
+    if (gap > slot->max_gap) {
+        slot->max_gap = gap;
+    }
+    slot->last_checkin = now;
+}
+
+
+int32_t watchdog_get_slot(uint32_t index, watchdog_slot_info_t *info) {
+    if (index >= WATCHDOG_MAX_TASKS || info == NULL) {
+        return -1;
+    }
+
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
+    const watchdog_slot_t *slot = &watchdog_slots[index];
+    if (slot->name == NULL) {
+        exit_critical_basepri(stat);
+        return -1;
+    }
+    info->name = slot->name;
+    info->handle = slot->handle;
+    info->timeout_ticks = slot->timeout_ticks;
+    info->since_checkin = systick_ticks - slot->last_checkin;
+    info->max_gap = slot->max_gap;
+    exit_critical_basepri(stat);
+
+    return 0;
+}
+
+
+const watchdog_record_t *watchdog_last_stall(void) {
+    return watchdog_record_valid() ? &watchdog_record : NULL;
+}
+
+
+void watchdog_clear_record(void) {
+    watchdog_record.magic = 0;
+}
+
+
+uint8_t watchdog_reset_by_iwdg(void) {
+    return watchdog_iwdg_reset;
+}
+
+#endif /* TASK_WATCHDOG */
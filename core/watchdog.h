@@ -0,0 +1,129 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Task watchdog
+ * =============
+ * Code that must keep making progress registers a named check-in slot with a
+ * deadline and calls watchdog_checkin() from its loop. A supervisor soft timer
+ * (SysTick context, every WATCHDOG_CHECK_TICKS) kicks the hardware IWDG only
+ * while every slot checked in within its deadline. The first slot to miss it
+ * is written to a .noinit record and the supervisor stops kicking, so the IWDG
+ * resets the MCU; after the reboot 'watchdog' reports the record.
+ *
+ * Slots are not tied to a task: a coroutine or a timer callback can own one,
+ * which covers the task that runs it. Tasks that block indefinitely by design
+ * (the CLI waiting for input) simply do not register. A slot does remember
+ * the task that claimed it, so it goes away with that task instead of
+ * tripping the watchdog once nobody is left to check in.
+ */
+
+typedef enum watchdog_status {
+    WATCHDOG_OK         = 0,
+    WATCHDOG_ERR_FULL   = -1,   /* All WATCHDOG_MAX_TASKS slots in use */
+    WATCHDOG_ERR_PARAM  = -2    /* Zero timeout or bad slot id */
+} watchdog_status_t;
+
+#define WATCHDOG_NAME_LEN       12
+#define WATCHDOG_RECORD_MAGIC   0x57445354u     /* "WDST" */
+
+/* Stall record, kept in .noinit RAM across the watchdog reset */
+typedef struct watchdog_record {
+    uint32_t magic;                     /* WATCHDOG_RECORD_MAGIC when valid */
+    char     name[WATCHDOG_NAME_LEN];   /* Copy of the slot name */
+    uint32_t handle;                    /* Task that registered the slot */
+    uint32_t timeout_ticks;
+    uint32_t silent_ticks;              /* Since its last check-in, when caught */
+    uint32_t uptime_ticks;              /* systick_ticks when caught */
+    uint32_t stalls;                    /* Stalls recorded since the record was cleared */
+    uint32_t checksum;
+} watchdog_record_t;
+
+/* One registered slot, for reporting */
+typedef struct watchdog_slot_info {
+    const char   *name;
+    task_handle_t handle;
+    uint32_t      timeout_ticks;
+    uint32_t      since_checkin;        /* Ticks since the last check-in */
+    uint32_t      max_gap;              /* Longest gap between check-ins seen */
+} watchdog_slot_info_t;
+
+
+/**
+ * @brief Read the reset cause, validate the stall record and set up the
+ * supervisor timer. Call once before any other watchdog function.
+ */
+void watchdog_init(void);
+
+
+/**
+ * @brief Start the IWDG and the supervisor. Cannot be undone until reset.
+ *
+ * @return 0 on success, -1 if the IWDG rejected WATCHDOG_IWDG_TIMEOUT_MS
+ */
+int32_t watchdog_start(void);
+
+
+/**
+ * @brief Claim a check-in slot; the first deadline runs from now.
+ *
+ * A slot claimed by a task is released when that task exits or is deleted.
+ * One claimed before the scheduler starts, or from an ISR, belongs to no
+ * task and stays until watchdog_unregister().
+ *
+ * @param name          Shown in reports; must outlive the slot
+ * @param timeout_ticks Longest allowed gap between check-ins
+ * @return Slot id (>= 0) or a negative watchdog_status_t
+ */
+int32_t watchdog_register(const char *name, uint32_t timeout_ticks);
+
+
+/**
+ * @brief Release a slot; it is no longer supervised.
+ */
+int32_t watchdog_unregister(int32_t id);
+
+
+/**
+ * @brief Report progress on a slot. Safe from tasks and ISRs.
+ */
+void watchdog_checkin(int32_t id);
+
+
+/**
+ * @brief Describe slot index (0 .. WATCHDOG_MAX_TASKS - 1).
+ *
+ * @return 0 if the slot is registered, -1 otherwise
+ */
+int32_t watchdog_get_slot(uint32_t index, watchdog_slot_info_t *info);
+
+
+/**
+ * @brief Stall record from this or an earlier run, or NULL if there is none.
+ */
+const watchdog_record_t *watchdog_last_stall(void);
+
+
+/**
+ * @brief Forget the stall record.
+ */
+void watchdog_clear_record(void);
+
+
+/**
+ * @brief Non-zero if the IWDG caused the last reset.
+ */
+uint8_t watchdog_reset_by_iwdg(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WATCHDOG_H */
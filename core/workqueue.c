@@ -0,0 +1,169 @@
+#include "workqueue.h"
+#include "scheduler.h"
+#include "project_config.h"
+
+/*
+ * Bounded MPMC ring with a sequence number per slot:
+ *   seq == pos          slot free for the producer that claims position pos
+ *   seq == pos + 1      slot holds the item of position pos, ready to run
+ *   seq == pos + size   slot consumed, free for position pos + size
+ * Producers and consumers claim positions with a CAS on enqueue_pos /
+ * dequeue_pos and publish through seq, so neither side ever masks interrupts.
+ */
+
+workqueue_t workqueue_system;
+static work_slot_t workqueue_system_slots[WORKQUEUE_SYSTEM_DEPTH];
+
+
+static uint8_t workqueue_cas(volatile uint32_t *value, uint32_t expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(value, &expected, desired, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+
+/* Take the oldest published item; returns 0 when none is ready */
+static uint8_t workqueue_take(workqueue_t *wq, work_fn_t *fn, void **arg) {
+    uint32_t pos = wq->dequeue_pos;
+
+    while (1) {
+        work_slot_t *slot = &wq->slots[pos & wq->mask];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+
+        if (diff == 0) {
+            if (workqueue_cas(&wq->dequeue_pos, pos, pos + 1)) {
+                *fn = slot->fn;
+                *arg = slot->arg;
+                __atomic_store_n(&slot->seq, pos + wq->mask + 1, __ATOMIC_RELEASE);
+                return 1;
+            }
+            pos = wq->dequeue_pos;
+        } else if (diff < 0) {
+            return 0;   /* Empty, or the next item is still being written */
+        } else {
+            pos = wq->dequeue_pos;  /* Another worker took it */
+        }
+    }
+}
+
+
+static void workqueue_worker(void *arg) {
+    workqueue_t *wq = (workqueue_t *)arg;
+
+    while (1) {
+        semaphore_take(&wq->ready, WAIT_FOREVER);
+
+        /* Cleared before draining: anything submitted from here on signals again */
+        __atomic_store_n(&wq->signalled, 0, __ATOMIC_SEQ_CST);
+
+        work_fn_t fn;
+        void *item_arg;
+        uint32_t batch = 0;
+
+        while (workqueue_take(wq, &fn, &item_arg)) {
+            fn(item_arg);
+            batch++;
+        }
+
+        __atomic_add_fetch(&wq->stats.executed, batch, __ATOMIC_RELAXED);
+        if (batch > wq->stats.max_batch) {
+            wq->stats.max_batch = batch;
+        }
+    }
+}
+
+
+int32_t workqueue_init(workqueue_t *wq, const char *name, work_slot_t *slots, uint32_t capacity) {
+    if (wq == NULL || slots == NULL || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return WORKQUEUE_ERR_PARAM;
+    }
+
+    wq->name = name;
+    wq->slots = slots;
+    wq->mask = capacity - 1;
+    wq->enqueue_pos = 0;
+    wq->dequeue_pos = 0;
+    wq->signalled = 0;
+
+    for (uint32_t i = 0; i < capacity; ++i) {
+        slots[i].seq = i;
+        slots[i].fn = NULL;
+        slots[i].arg = NULL;
+    }
+
+    /* One unit per wakeup; a waiting worker takes it directly */
+    semaphore_init(&wq->ready, 0, 1);
+
+    wq->stats.submitted = 0;
+    wq->stats.executed = 0;
+    wq->stats.overflows = 0;
+    wq->stats.max_batch = 0;
+
+    return WORKQUEUE_OK;
+}
+
+
+int32_t workqueue_start(workqueue_t *wq, uint32_t count, uint8_t priority, size_t stack_bytes) {
+    if (wq == NULL || wq->slots == NULL || count == 0) {
+        return WORKQUEUE_ERR_PARAM;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        int32_t handle = task_create(workqueue_worker, wq, stack_bytes);
+        if (handle < 0) {
+            return WORKQUEUE_ERR_TASK;
+        }
+        task_set_priority((task_handle_t)handle, priority);
+    }
+
+    return WORKQUEUE_OK;
+}
+
+
+int32_t workqueue_submit(workqueue_t *wq, work_fn_t fn, void *arg) {
+    if (wq == NULL || fn == NULL) {
+        return WORKQUEUE_ERR_PARAM;
+    }
+
+    uint32_t pos = wq->enqueue_pos;
+
+    while (1) {
+        work_slot_t *slot = &wq->slots[pos & wq->mask];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+
+        if (diff == 0) {
+            if (workqueue_cas(&wq->enqueue_pos, pos, pos + 1)) {
+                slot->fn = fn;
+                slot->arg = arg;
+                __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+                break;
+            }
+            pos = wq->enqueue_pos;
+        } else if (diff < 0) {
+            __atomic_add_fetch(&wq->stats.overflows, 1, __ATOMIC_RELAXED);
+            return WORKQUEUE_ERR_FULL;
+        } else {
+            pos = wq->enqueue_pos;  /* Lost the race to another producer */
+        }
+    }
+
+    __atomic_add_fetch(&wq->stats.submitted, 1, __ATOMIC_RELAXED);
+
+    /* Only the first submission after a worker started draining needs a wakeup */
+    if (__atomic_exchange_n(&wq->signalled, 1, __ATOMIC_SEQ_CST) == 0) {
+        semaphore_give(&wq->ready);
+    }
+
+    return WORKQUEUE_OK;
+}
+
+
+int32_t workqueue_system_init(void) {
+    int32_t status = workqueue_init(&workqueue_system, "system", workqueue_system_slots,
+                                    WORKQUEUE_SYSTEM_DEPTH);
+    if (status != WORKQUEUE_OK) {
+        return status;
+    }
+
+    return workqueue_start(&workqueue_system, WORKQUEUE_SYSTEM_WORKERS,
+                           WORKQUEUE_SYSTEM_PRIORITY, WORKQUEUE_SYSTEM_STACK);
+}
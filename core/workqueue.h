@@ -0,0 +1,111 @@
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "semaphore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Work queues (deferred interrupt work)
+ * =====================================
+ * An ISR hands the slow part of its job (parsing, callbacks, logging) to a
+ * worker task as a function + argument, and returns. Workers run at a
+ * normal task priority, so the work can be preempted and may block.
+ *
+ * Submission is lock-free: a bounded ring where every slot carries a
+ * sequence number (multi-producer, multi-consumer). Claiming a slot is one
+ * LDREX/STREX compare-and-swap, so nested ISRs can submit without masking
+ * interrupts. The workers are only signalled (one semaphore_give) when they
+ * may be idle; while they are draining, further submissions just land in
+ * the ring and are picked up in the same batch. That wakeup is a kernel
+ * call, so submitters must run at or below MAX_SYSCALL_PRIORITY; ISRs
+ * above it (e.g. the profiler's TIM7) must not submit.
+ *
+ * Items run in submission order per queue when there is one worker. With
+ * several workers, items are started in order but may run concurrently.
+ */
+
+typedef void (*work_fn_t)(void *arg);
+
+/* One ring slot; storage is provided by the caller */
+typedef struct work_slot {
+    volatile uint32_t seq;      /* Slot state, see workqueue.c */
+    work_fn_t         fn;
+    void             *arg;
+} work_slot_t;
+
+typedef struct workqueue_stats {
+    uint32_t submitted;
+    uint32_t executed;
+    uint32_t overflows;     /* Submissions refused because the ring was full */
+    uint32_t max_batch;     /* Most items a worker ran per wakeup */
+} workqueue_stats_t;
+
+typedef struct workqueue {
+    const char       *name;
+    work_slot_t      *slots;
+    uint32_t          mask;             /* capacity - 1 */
+    volatile uint32_t enqueue_pos;
+    volatile uint32_t dequeue_pos;
+    volatile uint32_t signalled;        /* Workers already woken for pending items */
+    semaphore_t       ready;
+    workqueue_stats_t stats;
+} workqueue_t;
+
+typedef enum workqueue_status {
+    WORKQUEUE_OK        = 0,
+    WORKQUEUE_ERR_FULL  = -1,   /* Ring full; the item was not queued */
+    WORKQUEUE_ERR_PARAM = -2,   /* NULL queue/function or bad capacity */
+    WORKQUEUE_ERR_TASK  = -3    /* Worker task could not be created */
+} workqueue_status_t;
+
+/* Shared queue for drivers, started by workqueue_system_init() */
+extern workqueue_t workqueue_system;
+
+
+/**
+ * @brief Initialize a work queue over caller-provided slots.
+ *
+ * @param capacity Number of slots, a power of two >= 2
+ * @return WORKQUEUE_OK or WORKQUEUE_ERR_PARAM
+ */
+int32_t workqueue_init(workqueue_t *wq, const char *name, work_slot_t *slots, uint32_t capacity);
+
+
+/**
+ * @brief Create worker tasks that drain the queue.
+ *
+ * @param count Number of workers (usually 1)
+ * @param priority Task priority of the workers
+ * @param stack_bytes Stack of each worker; must fit the deepest work item
+ * @return WORKQUEUE_OK or a negative workqueue_status_t
+ */
+int32_t workqueue_start(workqueue_t *wq, uint32_t count, uint8_t priority, size_t stack_bytes);
+
+
+/**
+ * @brief Queue fn(arg) to run in a worker. O(1), no interrupt masking on the
+ * ring itself; safe from tasks and ISRs at or below MAX_SYSCALL_PRIORITY.
+ *
+ * @return WORKQUEUE_OK, WORKQUEUE_ERR_FULL or WORKQUEUE_ERR_PARAM
+ */
+int32_t workqueue_submit(workqueue_t *wq, work_fn_t fn, void *arg);
+
+
+/**
+ * @brief Set up and start the system work queue (WORKQUEUE_SYSTEM_* settings).
+ * Call once before scheduler_start().
+ *
+ * @return WORKQUEUE_OK or a negative workqueue_status_t
+ */
+int32_t workqueue_system_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORKQUEUE_H */
@@ -0,0 +1,66 @@
+#include <stddef.h>
+#include "basic_timer.h"
+#include "system_clock.h"
+
+/***************** RCC_APB1ENR1 ******************/
+#define RCC_APB1ENR1_TIM6EN     (1UL << 4)
+#define RCC_APB1ENR1_TIM7EN     (1UL << 5)
+
+/***************** TIMx_CR1 ******************/
+#define TIM_CR1_CEN             (1UL << 0)  /* Counter enable */
+#define TIM_CR1_URS             (1UL << 2)  /* Only overflow raises the update interrupt */
+
+/***************** TIMx_DIER / TIMx_EGR ******************/
+#define TIM_DIER_UIE            (1UL << 0)  /* Update interrupt enable */
+#define TIM_EGR_UG              (1UL << 0)  /* Load PSC/ARR now */
+
+#define BASIC_TIMER_COUNT_HZ    1000000UL
+
+
+/* Start the counter with an update interrupt every 1/rate_hz */
+int basic_timer_start(TIM_Basic_t *TIMx, uint32_t rate_hz)
+{
+    uint32_t enable;
+    if (TIMx == TIM6) {
+        enable = RCC_APB1ENR1_TIM6EN;
+    } else if (TIMx == TIM7) {
+        enable = RCC_APB1ENR1_TIM7EN;
+    } else {
+        return -1;
+    }
+
+    /* APB1 runs undivided, so the timer clock is SYSCLK */
+    uint32_t clock_hz = get_system_clock_hz();
+    if (rate_hz == 0 || clock_hz < BASIC_TIMER_COUNT_HZ) {
+        return -1;
+    }
+
+    uint32_t reload = (BASIC_TIMER_COUNT_HZ + rate_hz / 2U) / rate_hz;
+    if (reload == 0 || reload > 0x10000UL) {
+        return -1;
+    }
+
+    RCC->APB1ENR1 |= enable;
+    (void)RCC->APB1ENR1;    /* Let the clock enable settle before touching the timer */
+
+    TIMx->CR1 = 0;
+    TIMx->PSC = (clock_hz / BASIC_TIMER_COUNT_HZ) - 1U;
+    TIMx->ARR = reload - 1U;
+    TIMx->CR1 = TIM_CR1_URS;
+    TIMx->EGR = TIM_EGR_UG;     /* Latch PSC/ARR; URS keeps this from interrupting */
+    TIMx->SR = 0;
+    TIMx->CNT = 0;
+    TIMx->DIER = TIM_DIER_UIE;
+    TIMx->CR1 |= TIM_CR1_CEN;
+
+    return 0;
+}
+
+
+/* Stop counting and mask the update interrupt */
+void basic_timer_stop(TIM_Basic_t *TIMx)
+{
+    TIMx->CR1 &= ~TIM_CR1_CEN;
+    TIMx->DIER = 0;
+    TIMx->SR = 0;
+}
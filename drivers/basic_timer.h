@@ -0,0 +1,40 @@
+#ifndef BASIC_TIMER_H
+#define BASIC_TIMER_H
+
+#include <stdint.h>
+#include "device_registers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Run a basic timer (TIM6/TIM7) with an update interrupt at rate_hz.
+ *
+ * The timer counts at 1 MHz from the APB1 timer clock, so rates from
+ * 16 Hz to 1 MHz are possible; the actual rate is 1 MHz / round(1 MHz / rate_hz).
+ * The caller enables the NVIC line.
+ *
+ * @return 0 on success, -1 for an unsupported timer or rate
+ */
+int basic_timer_start(TIM_Basic_t *TIMx, uint32_t rate_hz);
+
+
+/**
+ * @brief Stop the counter and its update interrupt.
+ */
+void basic_timer_stop(TIM_Basic_t *TIMx);
+
+
+/**
+ * @brief Acknowledge the update interrupt; call first thing in the handler.
+ */
+static inline void basic_timer_clear_update(TIM_Basic_t *TIMx) {
+    TIMx->SR = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BASIC_TIMER_H */
@@ -0,0 +1,20 @@
+#include "dwt.h"
+
+/***************** CoreDebug_DEMCR ******************/
+/* Global enable for DWT and ITM */
+#define COREDEBUG_DEMCR_TRCENA_POS  24U
+#define COREDEBUG_DEMCR_TRCENA_MASK (1UL << COREDEBUG_DEMCR_TRCENA_POS)
+
+/***************** DWT_CTRL ******************/
+/* Enable the cycle counter */
+#define DWT_CTRL_CYCCNTENA_POS      0U
+#define DWT_CTRL_CYCCNTENA_MASK     (1UL << DWT_CTRL_CYCCNTENA_POS)
+
+
+/* Enable the free-running cycle counter */
+void dwt_init(void)
+{
+    COREDEBUG->DEMCR |= COREDEBUG_DEMCR_TRCENA_MASK;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_MASK;
+}
@@ -0,0 +1,39 @@
+#ifndef DWT_H
+#define DWT_H
+
+#include <stdint.h>
+#include "device_registers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Enable the DWT cycle counter (CYCCNT).
+ * 
+ * Sets DEMCR.TRCENA and DWT_CTRL.CYCCNTENA and resets the counter.
+ * The counter runs at SYSCLK and wraps every 2^32 cycles (~53 s at 80 MHz),
+ * so always compare timestamps with unsigned subtraction.
+ */
+void dwt_init(void);
+
+
+/**
+ * @brief Read the free-running cycle counter.
+ * 
+ * @return Current value of DWT->CYCCNT
+ */
+#ifndef UNIT_TESTING
+static inline uint32_t dwt_get_cycles(void) {
+    return DWT->CYCCNT;
+}
+#else
+uint32_t dwt_get_cycles(void);  /* Provided by the host port (tests/host_port.c) */
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DWT_H */
@@ -0,0 +1,60 @@
+#include "iwdg.h"
+
+/***************** IWDG_KR ******************/
+#define IWDG_KEY_ENABLE         0xCCCCu     /* Start the watchdog (also starts the LSI) */
+#define IWDG_KEY_ACCESS         0x5555u     /* Unlock PR/RLR/WINR */
+
+/***************** IWDG_SR ******************/
+#define IWDG_SR_BUSY            0x7u        /* PVU | RVU | WVU */
+
+#define IWDG_RELOAD_MAX         0xFFFu
+#define IWDG_LSI_HZ             32000UL
+
+/***************** RCC_CSR ******************/
+#define RCC_CSR_RMVF            (1UL << 23) /* Clear all reset flags */
+#define RCC_CSR_IWDGRSTF        (1UL << 29)
+
+/***************** DBGMCU_APB1FZR1 ******************/
+#define DBGMCU_APB1FZR1_IWDG_STOP (1UL << 12)
+
+
+/* Start the watchdog with the smallest prescaler that reaches timeout_ms */
+int iwdg_start(uint32_t timeout_ms)
+{
+    if (timeout_ms == 0 || timeout_ms > 32000U) {
+        return -1;
+    }
+
+    /* PR = 0..6 divides the LSI by 4 << PR */
+    uint32_t pr = 0;
+    uint32_t reload = (IWDG_LSI_HZ / 1000UL) * timeout_ms / 4U;
+    while (reload > IWDG_RELOAD_MAX + 1U && pr < 6U) {
+        pr++;
+        reload = (reload + 1U) / 2U;
+    }
+    if (reload == 0) {
+        reload = 1;
+    }
+
+    DBGMCU->APB1FZR1 |= DBGMCU_APB1FZR1_IWDG_STOP;
+
+    IWDG->KR = IWDG_KEY_ENABLE;
+    IWDG->KR = IWDG_KEY_ACCESS;
+    IWDG->PR = pr;
+    IWDG->RLR = reload - 1U;
+    while (IWDG->SR & IWDG_SR_BUSY) {
+        /* Wait for the LSI domain to take PR/RLR */
+    }
+    iwdg_kick();
+
+    return 0;
+}
+
+
+/* Report and clear the reset cause */
+uint8_t iwdg_take_reset_flag(void)
+{
+    uint8_t by_iwdg = (RCC->CSR & RCC_CSR_IWDGRSTF) != 0;
+    RCC->CSR |= RCC_CSR_RMVF;
+    return by_iwdg;
+}
@@ -0,0 +1,45 @@
+#ifndef IWDG_H
+#define IWDG_H
+
+#include <stdint.h>
+#include "device_registers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start the independent watchdog with the given timeout.
+ *
+ * The IWDG runs from the 32 kHz LSI and cannot be stopped again until the
+ * next reset. It is frozen while the core is halted by a debugger.
+ *
+ * @param timeout_ms 1 .. 32000 (LSI tolerance makes the real timeout vary)
+ * @return 0 on success, -1 if the timeout is out of range
+ */
+int iwdg_start(uint32_t timeout_ms);
+
+
+/**
+ * @brief Reload the counter (kick the dog).
+ */
+static inline void iwdg_kick(void) {
+    IWDG->KR = 0xAAAAu;
+}
+
+
+/**
+ * @brief Read and clear the reset flags.
+ *
+ * Call once at boot: the flags are shared with the other reset causes and
+ * are cleared here so the next boot sees only its own cause.
+ *
+ * @return Non-zero if the last reset came from the IWDG
+ */
+uint8_t iwdg_take_reset_flag(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IWDG_H */
@@ -0,0 +1,72 @@
+#include "mpu.h"
+#include "utils.h"
+
+/***************** MPU_CTRL ******************/
+/* Enable the MPU */
+#define MPU_CTRL_ENABLE_POS         0U
+#define MPU_CTRL_ENABLE_MASK        (1UL << MPU_CTRL_ENABLE_POS)
+
+/* Privileged accesses outside all regions use the default memory map */
+#define MPU_CTRL_PRIVDEFENA_POS     2U
+#define MPU_CTRL_PRIVDEFENA_MASK    (1UL << MPU_CTRL_PRIVDEFENA_POS)
+
+/***************** MPU_RASR ******************/
+#define MPU_RASR_ENABLE_POS         0U
+#define MPU_RASR_ENABLE_MASK        (1UL << MPU_RASR_ENABLE_POS)
+
+/* Region size is 2^(SIZE + 1) bytes */
+#define MPU_RASR_SIZE_POS           1U
+#define MPU_RASR_SIZE(log2_bytes)   ((uint32_t)((log2_bytes) - 1U) << MPU_RASR_SIZE_POS)
+
+/* AP = 0b000: no access, privileged or not */
+#define MPU_RASR_AP_POS             24U
+#define MPU_RASR_AP_NONE            (0UL << MPU_RASR_AP_POS)
+
+/* Execute never */
+#define MPU_RASR_XN_POS             28U
+#define MPU_RASR_XN_MASK            (1UL << MPU_RASR_XN_POS)
+
+/***************** SCB_SHCSR ******************/
+#define SCB_SHCSR_MEMFAULTENA_POS   16U
+#define SCB_SHCSR_MEMFAULTENA_MASK  (1UL << SCB_SHCSR_MEMFAULTENA_POS)
+
+/***************** FPU_FPCCR ******************/
+/* Lazy FPU state preservation pending */
+#define FPU_FPCCR_LSPACT_POS        0U
+#define FPU_FPCCR_LSPACT_MASK       (1UL << FPU_FPCCR_LSPACT_POS)
+
+
+/* Program the guard region and turn on the MPU */
+void mpu_stack_guard_init(uint32_t guard_base)
+{
+    MPU->CTRL = 0;
+
+    MPU->RNR = MPU_STACK_GUARD_REGION;
+    MPU->RBAR = guard_base | MPU_RBAR_VALID | MPU_STACK_GUARD_REGION;
+    MPU->RASR = MPU_RASR_XN_MASK
+              | MPU_RASR_AP_NONE
+              | MPU_RASR_SIZE(STACK_GUARD_SIZE_LOG2)
+              | MPU_RASR_ENABLE_MASK;
+
+    /* MemManage instead of escalating to HardFault, so the task can be killed */
+    SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_MASK;
+
+    MPU->CTRL = MPU_CTRL_ENABLE_MASK | MPU_CTRL_PRIVDEFENA_MASK;
+    __DSB();
+    __ISB();
+}
+
+
+/* Read and clear MMFSR; MMFAR is only meaningful with MMARVALID */
+uint32_t mpu_fault_take(uint32_t *address)
+{
+    uint32_t mmfsr = SCB->CFSR & MPU_MMFSR_MASK;
+
+    *address = (mmfsr & MPU_MMFSR_MMARVALID) ? SCB->MMFAR : 0;
+    SCB->CFSR = mmfsr;  /* Write-one-to-clear */
+
+    /* A pending lazy save would target the dead stack's frame */
+    FPU->FPCCR &= ~FPU_FPCCR_LSPACT_MASK;
+
+    return mmfsr;
+}
@@ -0,0 +1,80 @@
+#ifndef MPU_H
+#define MPU_H
+
+#include <stdint.h>
+#include "device_registers.h"
+#include "project_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * MPU stack guard
+ * ===============
+ * A single no-access region (STACK_GUARD_SIZE bytes, execute-never) that the
+ * scheduler moves to the bottom of the incoming task's stack on every switch.
+ * Everything else uses the default memory map (PRIVDEFENA), so the guard is
+ * the only thing the MPU ever refuses.
+ *
+ * The highest region number wins where regions overlap, so the guard keeps
+ * working if other regions are added below it.
+ */
+#define MPU_STACK_GUARD_REGION  7u
+
+/* RBAR: VALID makes the write select the region in RBAR[3:0] */
+#define MPU_RBAR_VALID          (1UL << 4)
+
+/* MMFSR (CFSR[7:0]) */
+#define MPU_MMFSR_IACCVIOL      (1UL << 0)    /* Instruction fetch from a protected region */
+#define MPU_MMFSR_DACCVIOL      (1UL << 1)    /* Load/store to a protected region */
+#define MPU_MMFSR_MUNSTKERR     (1UL << 3)    /* Fault while unstacking on exception return */
+#define MPU_MMFSR_MSTKERR       (1UL << 4)    /* Fault while stacking on exception entry */
+#define MPU_MMFSR_MLSPERR       (1UL << 5)    /* Fault during lazy FPU state preservation */
+#define MPU_MMFSR_MMARVALID     (1UL << 7)    /* MMFAR holds the faulting address */
+#define MPU_MMFSR_MASK          0xFFUL
+
+#ifndef UNIT_TESTING
+/**
+ * @brief Program the guard region at guard_base and enable the MPU and MemManage.
+ * 
+ * @param guard_base Guard address of the first task (aligned to STACK_GUARD_SIZE)
+ */
+void mpu_stack_guard_init(uint32_t guard_base);
+
+
+/**
+ * @brief Move the guard region. One register write; called on every context switch.
+ * 
+ * Takes effect for the task at the exception return that ends PendSV.
+ * 
+ * @param guard_base Guard address (aligned to STACK_GUARD_SIZE)
+ */
+static inline void mpu_stack_guard_set(uint32_t guard_base) {
+    MPU->RBAR = guard_base | MPU_RBAR_VALID | MPU_STACK_GUARD_REGION;
+}
+
+
+/**
+ * @brief Read and clear the MemManage fault status (MemManage handler only).
+ * 
+ * Also drops any pending lazy FPU save, whose target may be the stack that
+ * just faulted.
+ * 
+ * @param address Set to MMFAR when MMARVALID, else 0
+ * @return MMFSR bits of the fault
+ */
+uint32_t mpu_fault_take(uint32_t *address);
+#else
+/* Host builds have no MPU */
+static inline void mpu_stack_guard_init(uint32_t guard_base) { (void)guard_base; }
+static inline void mpu_stack_guard_set(uint32_t guard_base) { (void)guard_base; }
+static inline uint32_t mpu_fault_take(uint32_t *address) { *address = 0; return 0; }
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPU_H */
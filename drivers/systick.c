@@ -1,5 +1,6 @@
 #include "systick.h"
 #include "utils.h"
+#include "trace.h"
 
 /***************** SYS_CSR ******************/
 /* set to 1 to enable SysTick */
@@ -42,6 +43,10 @@
 #define SYST_CALIB_NOREF_MASK   (1UL << SYST_CALIB_NOREF_POS)
 
 extern void scheduler_wake_sleeping_tasks(void);
+#if SCHEDULER_EDF
+extern void scheduler_edf_tick(void);
+#endif
+extern void soft_timer_tick(void);
 
 /* Simple global tick counter incremented on each SysTick interrupt */
 volatile uint32_t systick_ticks = 0;
@@ -49,12 +54,22 @@ volatile uint32_t systick_ticks = 0;
 /* SysTick interrupt handler */
 void SysTick_Handler(void)
 {
+    TRACE_ISR_ENTER();
     systick_ticks++;
 
+#if SCHEDULER_EDF
+    /* EDF budgets and deadlines, before the wake scan picks up replenished tasks */
+    scheduler_edf_tick();
+#endif
+
     /* Wake any tasks that have finished sleeping */
     scheduler_wake_sleeping_tasks();
 
+    /* Run SysTick-context timers and kick the timer daemon if one is due */
+    soft_timer_tick();
+
     yield_cpu(); /* trigger context switch */
+    TRACE_ISR_EXIT();
 }
 
 
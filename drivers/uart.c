@@ -2,6 +2,7 @@
 #include "uart.h"
 #include "utils.h"
 #include "project_config.h"
+#include "trace.h"
 
 /* RCC_AHB2ENR  – AHB2 peripheral clock enable register
  * Bits 3:0 control the clock to GPIOA..GPIOD.
@@ -533,7 +534,7 @@ uint32_t uart_available(USART_t *UARTx)
         return 0;
     }
 
-    uint32_t basepri_state = enter_critical_basepri(MAX_SYSCALL_PRIORITY); 
+    uint32_t basepri_state = enter_critical_basepri(MAX_SYSCALL_BASEPRI); 
     uint32_t head = uart_rx_head[idx];
     uint32_t tail = uart_rx_tail[idx];
     exit_critical_basepri(basepri_state);
@@ -552,7 +553,7 @@ uint32_t uart_read_buffer(USART_t *UARTx, char *dst, uint32_t len)
 
     uint32_t copied = 0;
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
     uint32_t head = uart_rx_head[idx];
     uint32_t tail = uart_rx_tail[idx];
 
@@ -668,7 +669,7 @@ uint32_t uart_write_buffer(USART_t *UARTx, const char *src, uint32_t len) {
     uint32_t basepri_state;
 
     /* Ensure critical section because interrupts modify */
-    basepri_state = enter_critical_basepri(MAX_SYSCALL_PRIORITY); 
+    basepri_state = enter_critical_basepri(MAX_SYSCALL_BASEPRI); 
 
     /* Loop and Enqueue Data */
     while (sent < len) {
@@ -722,7 +723,7 @@ uint32_t uart_tx_pending(USART_t *UARTx)
     int idx = uart_get_index(UARTx);
     if (idx < 0) return 0;
 
-    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_PRIORITY);
+    uint32_t stat = enter_critical_basepri(MAX_SYSCALL_BASEPRI);
     uint32_t head = uart_tx_head[idx];
     uint32_t tail = uart_tx_tail[idx];
     exit_critical_basepri(stat);
@@ -769,30 +770,42 @@ int uart_flush(USART_t *UARTx)
 /* Weak ISR wrappers override startup aliases and forward to generic handler */
 void USART1_IRQHandler(void)
 {
+    TRACE_ISR_ENTER();
     uart_irq_handler(USART1);
+    TRACE_ISR_EXIT();
 }
 
 void USART2_IRQHandler(void)
 {
+    TRACE_ISR_ENTER();
     uart_irq_handler(USART2);
+    TRACE_ISR_EXIT();
 }
 
 void USART3_IRQHandler(void)
 {
+    TRACE_ISR_ENTER();
     uart_irq_handler(USART3);
+    TRACE_ISR_EXIT();
 }
 
 void UART4_IRQHandler(void)
 {
+    TRACE_ISR_ENTER();
     uart_irq_handler(UART4);
+    TRACE_ISR_EXIT();
 }
 
 void UART5_IRQHandler(void)
 {
+    TRACE_ISR_ENTER();
     uart_irq_handler(UART5);
+    TRACE_ISR_EXIT();
 }
 
 void LPUART1_IRQHandler(void)
 {
+    TRACE_ISR_ENTER();
     uart_irq_handler(LPUART1);
+    TRACE_ISR_EXIT();
 }
@@ -35,15 +35,33 @@ extern "C" {
 #define USART1_BASE             (APB2PERIPH_BASE + 0x3800UL)
 #define LPUART1_BASE            (APB1PERIPH_BASE + 0x8000UL)
 
+/************* Independent watchdog base address *****************/
+#define IWDG_BASE               (APB1PERIPH_BASE + 0x3000UL)
+
+/************* Basic timer base addresses *****************/
+#define TIM6_BASE               (APB1PERIPH_BASE + 0x1000UL)
+#define TIM7_BASE               (APB1PERIPH_BASE + 0x1400UL)
+
 /************* SysTick base *****************/
 #define SYSTICK_BASE            (SCS_BASE + 0x0010UL) /* 0xE000E010 */
 
 /************* SCB base *****************/
 #define SCB_BASE                (SCS_BASE + 0x0D00UL) /* 0xE000ED00 */
+#define MPU_BASE                (SCS_BASE + 0x0D90UL) /* 0xE000ED90 */
 
 /************* NVIC base *****************/
 #define NVIC_BASE               (SCS_BASE + 0x0100UL) /* 0xE000E100UL */
 
+/************* Debug MCU (peripheral freeze in debug halt) *****************/
+#define DBGMCU_BASE             0xE0042000UL
+
+/************* DWT / CoreDebug base *****************/
+#define DWT_BASE                0xE0001000UL /* Data Watchpoint and Trace unit */
+#define COREDEBUG_BASE          0xE000EDF0UL /* Core Debug registers */
+
+/************* FPU base *****************/
+#define FPU_BASE                (SCS_BASE + 0x0F30UL) /* 0xE000EF30 */
+
 /************* REGISTER STRUCTURES *****************/
 /************* RCC Registers *****************/
 typedef struct {
@@ -126,6 +144,38 @@ typedef struct {
     volatile uint32_t TDR;      // 0x28 Transmit data register
 } USART_t;
 
+/************* Independent Watchdog Registers *****************/
+typedef struct {
+    volatile uint32_t KR;       // 0x00 Key register
+    volatile uint32_t PR;       // 0x04 Prescaler
+    volatile uint32_t RLR;      // 0x08 Reload
+    volatile uint32_t SR;       // 0x0C Status (PVU/RVU/WVU update in progress)
+    volatile uint32_t WINR;     // 0x10 Window
+} IWDG_t;
+
+/************* DBGMCU Registers *****************/
+typedef struct {
+    volatile uint32_t IDCODE;   // 0x00 Device ID
+    volatile uint32_t CR;       // 0x04 Debug configuration
+    volatile uint32_t APB1FZR1; // 0x08 APB1 freeze in debug, register 1
+    volatile uint32_t APB1FZR2; // 0x0C APB1 freeze in debug, register 2
+    volatile uint32_t APB2FZR;  // 0x10 APB2 freeze in debug
+} DBGMCU_t;
+
+/************* Basic Timer (TIM6/TIM7) Registers *****************/
+typedef struct {
+    volatile uint32_t CR1;        // 0x00 Control register 1
+    volatile uint32_t CR2;        // 0x04 Control register 2
+    volatile uint32_t RESERVED0;  // 0x08
+    volatile uint32_t DIER;       // 0x0C DMA/interrupt enable
+    volatile uint32_t SR;         // 0x10 Status
+    volatile uint32_t EGR;        // 0x14 Event generation
+    volatile uint32_t RESERVED1[3]; // 0x18-0x20
+    volatile uint32_t CNT;        // 0x24 Counter
+    volatile uint32_t PSC;        // 0x28 Prescaler
+    volatile uint32_t ARR;        // 0x2C Auto-reload
+} TIM_Basic_t;
+
 /************* SysTick Registers *****************/
 typedef struct {
     volatile uint32_t CSR;      // 0xE000E010 Control and Status
@@ -195,8 +245,53 @@ typedef struct {
     volatile uint32_t CCR;     /* 0x14 */
     volatile uint8_t  SHPR[12];/* 0x18–0x23: SHPR1–3 (4 bytes each) */
     volatile uint32_t SHCSR;   /* 0x24 */
+    volatile uint32_t CFSR;    /* 0x28 Configurable Fault Status (MMFSR | BFSR | UFSR) */
+    volatile uint32_t HFSR;    /* 0x2C HardFault Status */
+    volatile uint32_t DFSR;    /* 0x30 Debug Fault Status */
+    volatile uint32_t MMFAR;   /* 0x34 MemManage Fault Address */
+    volatile uint32_t BFAR;    /* 0x38 BusFault Address */
 } SCB_t;
 
+/************* MPU Registers *****************/
+typedef struct {
+    volatile uint32_t TYPE;    /* 0x00 Number of regions */
+    volatile uint32_t CTRL;    /* 0x04 Enable, background map */
+    volatile uint32_t RNR;     /* 0x08 Region number */
+    volatile uint32_t RBAR;    /* 0x0C Region base address */
+    volatile uint32_t RASR;    /* 0x10 Region attributes and size */
+} MPU_t;
+
+/************* DWT Registers *****************/
+typedef struct {
+    volatile uint32_t CTRL;     /* 0x00 Control */
+    volatile uint32_t CYCCNT;   /* 0x04 Cycle count */
+    volatile uint32_t CPICNT;   /* 0x08 CPI count */
+    volatile uint32_t EXCCNT;   /* 0x0C Exception overhead count */
+    volatile uint32_t SLEEPCNT; /* 0x10 Sleep count */
+    volatile uint32_t LSUCNT;   /* 0x14 LSU count */
+    volatile uint32_t FOLDCNT;  /* 0x18 Folded-instruction count */
+    volatile uint32_t PCSR;     /* 0x1C Program counter sample */
+} DWT_t;
+
+/************* CoreDebug Registers *****************/
+typedef struct {
+    volatile uint32_t DHCSR;    /* 0x00 Debug Halting Control and Status */
+    volatile uint32_t DCRSR;    /* 0x04 Debug Core Register Selector */
+    volatile uint32_t DCRDR;    /* 0x08 Debug Core Register Data */
+    volatile uint32_t DEMCR;    /* 0x0C Debug Exception and Monitor Control */
+} CoreDebug_t;
+
+/************* FPU Registers *****************/
+typedef struct {
+    volatile uint32_t RESERVED0; /* 0x00 */
+    volatile uint32_t FPCCR;     /* 0x04 Floating-point Context Control */
+    volatile uint32_t FPCAR;     /* 0x08 Floating-point Context Address */
+    volatile uint32_t FPDSCR;    /* 0x0C Floating-point Default Status Control */
+} FPU_t;
+
+/* Coprocessor Access Control Register (CP10/CP11 = FPU) */
+#define SCB_CPACR               (*((volatile uint32_t *)(SCB_BASE + 0x088UL)))
+
 /************* POINTERS TO INSTANCES *****************/
 #define RCC       ((RCC_t   *) RCC_BASE)
 #define FLASH     ((FLASH_t *) FLASH_BASE)
@@ -214,14 +309,38 @@ typedef struct {
 #define UART5     ((USART_t *) UART5_BASE)
 #define LPUART1   ((USART_t *) LPUART1_BASE)
 
+#define IWDG      ((IWDG_t *) IWDG_BASE)
+#define DBGMCU    ((DBGMCU_t *) DBGMCU_BASE)
+
+#define TIM6      ((TIM_Basic_t *) TIM6_BASE)
+#define TIM7      ((TIM_Basic_t *) TIM7_BASE)
+
 #define SYSTICK   ((SysTick_t *) SYSTICK_BASE)
 
 #define SCB       ((SCB_t *)SCB_BASE)
+#define MPU       ((MPU_t *)MPU_BASE)
+
+#define DWT       ((DWT_t *)DWT_BASE)
+#define COREDEBUG ((CoreDebug_t *)COREDEBUG_BASE)
+#define FPU       ((FPU_t *)FPU_BASE)
 
 /************* NVIC definitions *****************/
 #define NVIC_ISER0              (*((volatile uint32_t *)(NVIC_BASE + 0x000)))
 #define NVIC_ISER1              (*((volatile uint32_t *)(NVIC_BASE + 0x004)))
+#define NVIC_ISER(n)            (*((volatile uint32_t *)(NVIC_BASE + 0x000 + 4UL * (n)))) /* Set-enable */
+#define NVIC_ICER(n)            (*((volatile uint32_t *)(NVIC_BASE + 0x080 + 4UL * (n)))) /* Clear-enable */
+#define NVIC_ISPR(n)            (*((volatile uint32_t *)(NVIC_BASE + 0x100 + 4UL * (n)))) /* Set-pending */
+#define NVIC_ICPR(n)            (*((volatile uint32_t *)(NVIC_BASE + 0x180 + 4UL * (n)))) /* Clear-pending */
+#define NVIC_IPR(irq)           (*((volatile uint8_t  *)(NVIC_BASE + 0x300 + (irq))))      /* Priority, one byte per IRQ */
+#define NVIC_PRIO_BITS          4   /* STM32L4 implements the top 4 priority bits */
+
 #define USART2_IRQn             38
+#define TIM7_IRQn               55
+#define SAI1_IRQn               74
+#define SAI2_IRQn               75
+#define SWPMI1_IRQn             76
+#define TSC_IRQn                77
+#define LCD_IRQn                78
 
 
 #ifdef __cplusplus
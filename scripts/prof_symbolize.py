@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Name the hot functions in a 'prof dump' capture.
+
+Capture the console while running 'prof dump' (the "P <addr> <count>"
+lines), then
+
+    python3 scripts/prof_symbolize.py prof.txt stm32_cli_os.map
+
+Symbols come from the linker map the Makefile writes ($(TARGET).map).
+With --elf and arm-none-eabi-nm on the PATH, the ELF symbol table is used
+instead. Each bin is charged to the function containing its start address,
+so a bin that straddles two small functions counts for the first one.
+"""
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+FLASH_START = 0x08000000
+FLASH_END = 0x08100000
+
+BIN_LINE = re.compile(r"^P (0x[0-9a-fA-F]+) (\d+)\s*$")
+# " .text.name  0xADDR  0xSIZE  obj.o", possibly wrapped after the section name
+SECTION_LINE = re.compile(r"^ \.text(?:\.(\S+))?\s*$|^ \.text(?:\.(\S+))?\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)")
+WRAPPED_TAIL = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)")
+SYMBOL_LINE = re.compile(r"^\s+(0x[0-9a-f]+)\s+([A-Za-z_][\w.$]*)\s*$")
+
+
+def read_bins(path):
+    """Bins of the last 'prof dump' in the capture: {address: count}."""
+    blocks, current = [], None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = BIN_LINE.match(line.strip())
+            if m:
+                if current is None:
+                    current = {}
+                    blocks.append(current)
+                current[int(m[1], 16)] = current.get(int(m[1], 16), 0) + int(m[2])
+            elif line.strip():
+                current = None
+    if not blocks:
+        sys.exit("no 'P <addr> <count>' lines found in %s" % path)
+    return blocks[-1]
+
+
+def symbols_from_map(path):
+    """(address, size or 0, name, object) for code in FLASH."""
+    symbols = []
+    pending = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if pending is not None:
+                m = WRAPPED_TAIL.match(line)
+                if m:
+                    symbols.append((int(m[1], 16), int(m[2], 16), pending[0], m[3]))
+                pending = None
+                continue
+
+            m = SECTION_LINE.match(line)
+            if m:
+                if m[3] is None:
+                    pending = (m[1] or m[2] or "",)
+                else:
+                    symbols.append((int(m[3], 16), int(m[4], 16), m[2] or "", m[5]))
+                continue
+
+            m = SYMBOL_LINE.match(line)
+            if m:
+                symbols.append((int(m[1], 16), 0, m[2], ""))
+
+    return clean(symbols)
+
+
+def symbols_from_elf(path):
+    out = subprocess.run(["arm-none-eabi-nm", "-S", "-n", "--defined-only", path],
+                         check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "tTwW":
+            symbols.append((int(parts[0], 16), int(parts[1], 16), parts[3], ""))
+    return clean(symbols)
+
+
+def clean(symbols):
+    """Merge entries per address (name from symbol lines, size and object from sections)."""
+    merged = {}
+    for addr, size, name, obj in symbols:
+        if not FLASH_START <= addr < FLASH_END:
+            continue
+        old_size, old_name, old_obj = merged.get(addr, (0, "", ""))
+        merged[addr] = (max(size, old_size), old_name or name, old_obj or obj)
+    return [(addr,) + merged[addr] for addr in sorted(merged)]
+
+
+def lookup(symbols, starts, addr):
+    """Closest symbol at or below addr; static functions only have their own
+    entry when the map comes from a -ffunction-sections build or the ELF."""
+    i = bisect.bisect_right(starts, addr) - 1
+    return symbols[i] if i >= 0 else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="console capture containing 'prof dump' output")
+    parser.add_argument("map", nargs="?", default="stm32_cli_os.map", help="linker map file")
+    parser.add_argument("--elf", help="use the ELF symbol table (needs arm-none-eabi-nm)")
+    parser.add_argument("-n", "--top", type=int, default=25, help="functions to show (default 25)")
+    args = parser.parse_args()
+
+    bins = read_bins(args.capture)
+    symbols = symbols_from_elf(args.elf) if args.elf else symbols_from_map(args.map)
+    if not symbols:
+        sys.exit("no code symbols found")
+    starts = [s[0] for s in symbols]
+
+    per_function = {}
+    total = sum(bins.values())
+    for addr, count in bins.items():
+        sym = lookup(symbols, starts, addr)
+        key = (sym[2] or "?", sym[3]) if sym else ("<before first symbol>", "")
+        per_function[key] = per_function.get(key, 0) + count
+
+    print("%d samples in %d bins" % (total, len(bins)))
+    print("%7s %8s  %s" % ("%", "samples", "function"))
+    ranked = sorted(per_function.items(), key=lambda kv: kv[1], reverse=True)
+    for (name, obj), count in ranked[:args.top]:
+        where = "  (%s)" % obj if obj else ""
+        print("%6.2f%% %8d  %s%s" % (100.0 * count / total, count, name, where))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Convert a 'trace dump' capture to Chrome trace JSON.
+
+Capture the console while running 'trace dump', e.g.
+
+    picocom -b 115200 --logfile trace.bin /dev/ttyACM0
+
+then
+
+    python3 scripts/trace2chrome.py trace.bin -o trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+The capture may contain other console text; the dump is found by its
+"T <slot> <handle> <prio>" legend lines and the KTRC header.
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+
+MAGIC = b"KTRC"
+HEADER = struct.Struct("<IBBHIII")   # magic, version, record size, reserved, cpu_hz, count, lost
+RECORD = struct.Struct("<IBBH")      # cycles, event, task, arg
+
+EVENTS = {
+    1: "switch", 2: "sleep", 3: "wake", 4: "block", 5: "unblock",
+    6: "isr_enter", 7: "isr_exit", 8: "malloc", 9: "malloc_fail", 10: "free",
+}
+NO_TASK = 0xFF
+WAIT_RESULTS = {0: "ok", 0xFFFF: "timeout", 0xFFFE: "aborted"}
+
+# Cortex-M exception numbers (IRQ n is exception 16 + n)
+EXCEPTIONS = {
+    15: "SysTick", 16 + 37: "USART1", 16 + 38: "USART2", 16 + 39: "USART3",
+    16 + 52: "UART4", 16 + 53: "UART5", 16 + 70: "LPUART1",
+    16 + 74: "SST1 (SAI1)", 16 + 75: "SST2 (SAI2)", 16 + 76: "SST3 (SWPMI1)", 16 + 77: "SST4 (TSC)",
+}
+
+PID_TASKS = 1
+PID_ISRS = 2
+
+
+def parse_legend(text):
+    tasks = {}
+    for m in re.finditer(rb"^T (\d+) (\d+) (\d+)( idle)?\r?$", text, re.M):
+        slot, handle, prio, idle = int(m[1]), int(m[2]), int(m[3]), m[4] is not None
+        tasks[slot] = "idle" if idle else "task %d (0x%x, prio %d)" % (slot, handle, prio)
+    return tasks
+
+
+def decode(data):
+    # Last dump in the capture; the version/size check skips magic look-alikes in record data
+    start = len(data)
+    while True:
+        start = data.rfind(MAGIC, 0, start)
+        if start < 0 or len(data) < start + HEADER.size:
+            sys.exit("no trace dump (KTRC header) found")
+        _, version, rec_size, _, cpu_hz, count, lost = HEADER.unpack_from(data, start)
+        if version == 1 and rec_size == RECORD.size:
+            break
+
+    body = start + HEADER.size
+    available = (len(data) - body) // RECORD.size
+    if available < count:
+        print("warning: capture truncated, %d of %d records" % (available, count), file=sys.stderr)
+        count = available
+
+    records = [RECORD.unpack_from(data, body + i * RECORD.size) for i in range(count)]
+    return parse_legend(data[:start]), cpu_hz, lost, records
+
+
+def to_chrome(tasks, cpu_hz, records):
+    def name(slot):
+        if slot == NO_TASK:
+            return "kernel"
+        return tasks.get(slot, "task %d" % slot)
+
+    # 32-bit cycle counter: unwrap, then microseconds from the first record
+    ts, high, prev = [], 0, None
+    for cycles, _, _, _ in records:
+        if prev is not None and cycles < prev:
+            high += 1 << 32
+        prev = cycles
+        ts.append(high + cycles)
+    base = ts[0] if ts else 0
+    us = [(t - base) * 1e6 / cpu_hz for t in ts]
+
+    out = [
+        {"ph": "M", "name": "process_name", "pid": PID_TASKS, "args": {"name": "Tasks"}},
+        {"ph": "M", "name": "process_name", "pid": PID_ISRS, "args": {"name": "Interrupts"}},
+    ]
+    for slot in sorted(set(r[2] for r in records) | set(tasks)):
+        out.append({"ph": "M", "name": "thread_name", "pid": PID_TASKS, "tid": slot,
+                    "args": {"name": name(slot)}})
+
+    running, since, came_from = None, None, None
+    isr_depth = 0
+    for (cycles, event, slot, arg), t in zip(records, us):
+        kind = EVENTS.get(event, "event %d" % event)
+
+        if kind == "switch":
+            if running is not None:
+                out.append({"ph": "X", "name": "running", "pid": PID_TASKS, "tid": running,
+                            "ts": since, "dur": t - since, "args": {"from": came_from}})
+            running, since, came_from = slot, t, name(arg)
+        elif kind in ("isr_enter", "isr_exit"):
+            exc = EXCEPTIONS.get(arg, "exception %d" % arg)
+            if kind == "isr_enter":
+                isr_depth += 1
+                out.append({"ph": "B", "name": exc, "pid": PID_ISRS, "tid": 0, "ts": t,
+                            "args": {"interrupted": name(slot)}})
+            elif isr_depth > 0:
+                isr_depth -= 1
+                out.append({"ph": "E", "name": exc, "pid": PID_ISRS, "tid": 0, "ts": t})
+        else:
+            if kind == "wake":
+                args = {"result": WAIT_RESULTS.get(arg, arg)}
+            elif kind in ("sleep", "block"):
+                args = {"ticks": "forever" if arg == 0xFFFF and kind == "block" else arg}
+            else:
+                args = {"bytes": arg} if kind.startswith(("malloc", "free")) else {}
+            out.append({"ph": "i", "s": "t", "name": kind, "pid": PID_TASKS,
+                        "tid": slot, "ts": t, "args": args})
+
+    if running is not None and us:
+        out.append({"ph": "X", "name": "running", "pid": PID_TASKS, "tid": running,
+                    "ts": since, "dur": us[-1] - since, "args": {"from": came_from}})
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="raw console capture containing a 'trace dump'")
+    parser.add_argument("-o", "--output", default="-", help="JSON output file (default stdout)")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        tasks, cpu_hz, lost, records = decode(f.read())
+
+    trace = {"traceEvents": to_chrome(tasks, cpu_hz, records), "displayTimeUnit": "ns",
+             "otherData": {"cpu_hz": cpu_hz, "records": len(records), "overwritten": lost}}
+
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    print("%d records, %d overwritten before the dump" % (len(records), lost), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,13 @@
 // end of chapter 4 theres a install guide
 #include <stdint.h>
+#include "device_registers.h"
+
+/* CPACR: CP10/CP11 full access enables the FPU */
+#define SCB_CPACR_CP10_CP11_FULL    (0xFUL << 20)
+
+/* FPCCR: automatic FPU state preservation + lazy stacking */
+#define FPU_FPCCR_ASPEN             (1UL << 31)
+#define FPU_FPCCR_LSPEN             (1UL << 30)
 
 /* Linker script symbols */
 extern uint32_t _estack;   // Initial stack pointer
@@ -215,6 +223,14 @@ void (* const g_pfnVectors[])(void) = {
 /* ---------- Reset handler ---------- */
 void Reset_Handler(void)
 {
+    /* 0) Enable the FPU before any code can touch it (code is built with -mfloat-abi=hard).
+     *    ASPEN sets CONTROL.FPCA on first FPU use, LSPEN makes exception entry only
+     *    reserve S0-S15/FPSCR on the stack and save them when the handler uses the FPU. */
+    SCB_CPACR |= SCB_CPACR_CP10_CP11_FULL;
+    FPU->FPCCR |= FPU_FPCCR_ASPEN | FPU_FPCCR_LSPEN;
+    __asm volatile ("dsb 0xF" ::: "memory");
+    __asm volatile ("isb 0xF" ::: "memory");
+
     /* 1) Copy .data from FLASH to SRAM */
     uint32_t *src = &_sidata;
     uint32_t *dst = &_sdata;
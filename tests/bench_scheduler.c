@@ -0,0 +1,232 @@
+/*
+ * Host benchmark of the scheduler's hot paths (make bench).
+ *
+ * Runs core/scheduler.c on the PC through tests/host_port.c and times the
+ * operations that sit on the context switch and tick paths for several task
+ * counts, plus the signalling primitives. Absolute numbers are host
+ * nanoseconds, not target cycles; use them to compare scheduler changes
+ * against each other. The on-target numbers come from the 'bench' CLI command.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_port.h"
+#include "scheduler.h"
+#include "semaphore.h"
+#include "coroutine.h"
+#include "systick.h"
+
+#define BENCH_ROUNDS        50U     /* Samples per measurement (min/avg/max over these) */
+#define BENCH_OPS_PER_ROUND 2000U   /* Operations timed together in one sample */
+#define BENCH_SLEEP_TICKS   1000000U
+
+static const uint32_t task_counts[] = { 2U, 8U, 32U, MAX_TASKS - 1U };
+#define TASK_COUNTS_LEN (sizeof(task_counts) / sizeof(task_counts[0]))
+
+static task_handle_t handles[MAX_TASKS];
+
+typedef void (*bench_op_t)(uint32_t n);
+
+typedef struct bench_result {
+    double min_ns;
+    double avg_ns;
+    double max_ns;
+} bench_result_t;
+
+
+static void dummy_task(void *arg) {
+    (void)arg;
+}
+
+
+/* Fresh kernel with n user tasks plus idle, started, task_list[0] running */
+static void setup_tasks(uint32_t n) {
+    host_port_init();
+    for (uint32_t i = 0; i < n; ++i) {
+        int32_t handle = task_create(dummy_task, NULL, STACK_SIZE_512B);
+        if (handle < 0) {
+            fprintf(stderr, "task_create failed at %u tasks\n", (unsigned int)i);
+            exit(1);
+        }
+        handles[i] = (task_handle_t)handle;
+    }
+    scheduler_start();
+}
+
+
+/* Put every user task to sleep far in the future; only idle stays runnable */
+static void sleep_all(uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        host_run_as(task_from_handle(handles[i]));
+        task_sleep_ticks(BENCH_SLEEP_TICKS);
+    }
+    host_context_switch();
+}
+
+
+/* ---------- Measured operations ---------- */
+
+static void op_switch(uint32_t n) {
+    (void)n;
+    host_context_switch();
+}
+
+
+static void op_wake_scan(uint32_t n) {
+    (void)n;
+    scheduler_wake_sleeping_tasks();
+}
+
+
+static void op_create_delete_gc(uint32_t n) {
+    (void)n;
+    int32_t handle = task_create(dummy_task, NULL, STACK_SIZE_512B);
+    task_delete((task_handle_t)handle);
+    task_garbage_collection();
+}
+
+
+static uint32_t lookup_index = 0;
+
+static void op_lookup(uint32_t n) {
+    volatile task_t *task = task_from_handle(handles[lookup_index]);
+    (void)task;
+    lookup_index = (lookup_index + 1U < n) ? lookup_index + 1U : 0U;
+}
+
+
+/* Signal + consume without blocking: the bookkeeping cost of each mechanism */
+static semaphore_t bench_sem;
+
+static void op_semaphore_signal(uint32_t n) {
+    (void)n;
+    semaphore_give(&bench_sem);
+    semaphore_take(&bench_sem, 0);
+}
+
+
+static void op_notify_signal(uint32_t n) {
+    (void)n;
+    task_notify(task_current->handle, 1, NOTIFY_SET_BITS);
+    task_notify_wait(0xFFFFFFFFu, NULL, 0);
+}
+
+
+/* One runner pass over n coroutines that only yield; reported per resume */
+static coroutine_sched_t bench_coroutines;
+static coroutine_t coroutines[MAX_TASKS];
+
+static int8_t yield_coroutine(coroutine_t *co, void *arg) {
+    (void)arg;
+    CO_BEGIN(co);
+    while (1) {
+        CO_YIELD(co);
+    }
+    CO_END(co);
+}
+
+
+static void setup_coroutines(uint32_t n) {
+    host_port_init();
+    coroutine_sched_init(&bench_coroutines);
+    for (uint32_t i = 0; i < n; ++i) {
+        coroutine_start(&bench_coroutines, &coroutines[i], yield_coroutine, NULL);
+    }
+}
+
+
+static void op_coroutine_pass(uint32_t n) {
+    (void)n;
+    coroutine_sched_run_once(&bench_coroutines, NULL);
+}
+
+
+/* ---------- Harness ---------- */
+
+static bench_result_t bench_measure(bench_op_t op, uint32_t n) {
+    bench_result_t result = { 0.0, 0.0, 0.0 };
+    double total = 0.0;
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+        uint64_t start = host_time_ns();
+        for (uint32_t i = 0; i < BENCH_OPS_PER_ROUND; ++i) {
+            op(n);
+        }
+        double per_op = (double)(host_time_ns() - start) / BENCH_OPS_PER_ROUND;
+
+        if (round == 0 || per_op < result.min_ns) {
+            result.min_ns = per_op;
+        }
+        if (per_op > result.max_ns) {
+            result.max_ns = per_op;
+        }
+        total += per_op;
+    }
+    result.avg_ns = total / BENCH_ROUNDS;
+    return result;
+}
+
+
+static void bench_print(const char *name, uint32_t n, bench_result_t result) {
+    printf("%-32s %5u %9.1f %9.1f %9.1f\n", name, (unsigned int)n,
+           result.min_ns, result.avg_ns, result.max_ns);
+}
+
+
+int main(void) {
+    printf("Scheduler host benchmark (ns per operation)\n");
+    printf("%-32s %5s %9s %9s %9s\n", "Operation", "Tasks", "Min", "Avg", "Max");
+
+    for (uint32_t i = 0; i < TASK_COUNTS_LEN; ++i) {
+        uint32_t n = task_counts[i];
+        setup_tasks(n);
+        bench_print("switch, all ready", n, bench_measure(op_switch, n));
+    }
+
+    for (uint32_t i = 0; i < TASK_COUNTS_LEN; ++i) {
+        uint32_t n = task_counts[i];
+        setup_tasks(n);
+        sleep_all(n);
+        bench_print("switch, only idle ready", n, bench_measure(op_switch, n));
+    }
+
+    for (uint32_t i = 0; i < TASK_COUNTS_LEN; ++i) {
+        uint32_t n = task_counts[i];
+        setup_tasks(n);
+        sleep_all(n);
+        bench_print("wake scan, none due", n, bench_measure(op_wake_scan, n));
+    }
+
+    for (uint32_t i = 0; i < TASK_COUNTS_LEN; ++i) {
+        uint32_t n = task_counts[i];
+        if (n + 2U > MAX_TASKS) {
+            continue; /* Needs one free slot besides idle */
+        }
+        setup_tasks(n);
+        bench_print("create + delete + gc", n, bench_measure(op_create_delete_gc, n));
+    }
+
+    for (uint32_t i = 0; i < TASK_COUNTS_LEN; ++i) {
+        uint32_t n = task_counts[i];
+        setup_tasks(n);
+        lookup_index = 0;
+        bench_print("task_from_handle", n, bench_measure(op_lookup, n));
+    }
+
+    for (uint32_t i = 0; i < TASK_COUNTS_LEN; ++i) {
+        uint32_t n = task_counts[i];
+        setup_coroutines(n);
+        bench_result_t result = bench_measure(op_coroutine_pass, n);
+        result.min_ns /= n;
+        result.avg_ns /= n;
+        result.max_ns /= n;
+        bench_print("coroutine switch (yield)", n, result);
+    }
+
+    setup_tasks(2);
+    semaphore_init(&bench_sem, 0, 1);
+    bench_print("semaphore give + take", 2, bench_measure(op_semaphore_signal, 2));
+    bench_print("task_notify + notify_wait", 2, bench_measure(op_notify_signal, 2));
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+
+#include "host_port.h"
+#include "allocator.h"
+#include "systick.h"
+#include "dwt.h"
+#if KERNEL_BENCH
+#include "bench.h"
+#endif
+
+#define HOST_HEAP_SIZE (128U * 1024U)
+
+static uint8_t host_heap[HOST_HEAP_SIZE];
+
+volatile uint32_t systick_ticks = 0;
+volatile uint32_t host_yield_requests = 0;
+volatile uint32_t host_cycles = 0;
+
+
+/* ---------- Stand-ins for the target side ---------- */
+
+void yield_cpu(void) {
+    host_yield_requests++;
+}
+
+
+/* scheduler_start() jumps here on the target; on the host it simply returns */
+void task_create_first(void) {
+}
+
+
+uint32_t dwt_get_cycles(void) {
+    return host_cycles;
+}
+
+
+#if KERNEL_BENCH
+void bench_record(bench_id_t id, uint32_t cycles) {
+    (void)id;
+    (void)cycles;
+}
+#endif
+
+
+/* ---------- Host helpers ---------- */
+
+void host_port_init(void) {
+    allocator_init(host_heap, sizeof(host_heap));
+    systick_ticks = 0;
+    host_yield_requests = 0;
+    host_cycles = 0;
+    scheduler_init();
+}
+
+
+void host_context_switch(void) {
+    schedule_next_task();
+    task_current = task_next;
+}
+
+
+void host_tick(void) {
+    systick_ticks++;
+#if SCHEDULER_EDF
+    scheduler_edf_tick();
+#endif
+    scheduler_wake_sleeping_tasks();
+}
+
+
+void host_run_as(task_t *task) {
+    /* As a switch would: the task it replaces goes back to its ready queue */
+    if (task_current != NULL && task_current != task && task_current->state == TASK_RUNNING) {
+        task_set_state(task_current, TASK_READY);
+    }
+    task_current = task;
+    task_set_state(task, TASK_RUNNING);
+}
+
+
+uint64_t host_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
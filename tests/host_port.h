@@ -0,0 +1,60 @@
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+/*
+ * Host port of the kernel.
+ * Provides the pieces that normally come from the Cortex-M side (SysTick counter,
+ * PendSV trigger, DWT, first-task entry) so core/scheduler.c can be compiled with
+ * -DUNIT_TESTING and driven from a PC program. No task code ever runs: the host
+ * program plays the role of "the current task" and of the interrupt handlers.
+ */
+
+#include <stdint.h>
+#include "scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of yield_cpu() calls (PendSV requests) since host_port_init */
+extern volatile uint32_t host_yield_requests;
+
+/* What dwt_get_cycles() returns; tests advance it by hand */
+extern volatile uint32_t host_cycles;
+
+
+/**
+ * @brief Reset the heap, the scheduler and the tick counter.
+ */
+void host_port_init(void);
+
+
+/**
+ * @brief Do what PendSV does: pick the next task and make it current.
+ */
+void host_context_switch(void);
+
+
+/**
+ * @brief Do what SysTick does: advance the tick, run the EDF accounting and
+ * wake due sleepers.
+ */
+void host_tick(void);
+
+
+/**
+ * @brief Pretend a task is running, so calls like task_sleep_ticks() act on it.
+ */
+void host_run_as(task_t *task);
+
+
+/**
+ * @brief Monotonic time in nanoseconds.
+ */
+uint64_t host_time_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_PORT_H */
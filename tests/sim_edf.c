@@ -0,0 +1,176 @@
+/*
+ * Host simulator for the EDF class (make sim).
+ *
+ * Runs periodic task sets through core/scheduler.c on the PC, tick by tick:
+ * whichever task the scheduler picks "executes" for one tick, SysTick
+ * (host_tick) charges it, a job that has used up its execution time calls
+ * task_wait_next_period(), and PendSV (host_context_switch) picks the next
+ * task, as on the target. The admission test, budget enforcement and miss
+ * counting are the kernel's own, so a set that shows no misses here is
+ * schedulable on the target with the same tick, as long as the execution
+ * times hold.
+ *
+ * A fixed-priority background task below EDF_TASK_PRIORITY is always ready
+ * and takes whatever the EDF tasks leave.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_port.h"
+#include "scheduler.h"
+#include "systick.h"
+
+#define SIM_MAX_TASKS   4U
+
+typedef struct sim_task {
+    const char   *name;
+    edf_params_t  params;
+    uint32_t      exec_ticks;   /* Actual execution time per job (may exceed the budget) */
+    task_handle_t handle;       /* TASK_HANDLE_INVALID if admission refused it */
+    uint32_t      remaining;    /* Of the current job */
+} sim_task_t;
+
+typedef struct sim_set {
+    const char *name;
+    uint32_t    ticks;
+    uint32_t    count;
+    sim_task_t  tasks[SIM_MAX_TASKS];
+} sim_set_t;
+
+/* period, deadline (0 = period), budget; then actual execution time */
+static sim_set_t sim_sets[] = {
+    { "harmonic, U = 0.80", 4000U, 3U, {
+        { "ctrl",   { 10U, 0U, 3U }, 3U, 0, 0 },
+        { "filter", { 20U, 0U, 6U }, 6U, 0, 0 },
+        { "log",    { 40U, 0U, 8U }, 8U, 0, 0 },
+    } },
+    { "non-harmonic, U = 0.88 (above the RM bound)", 6000U, 3U, {
+        { "a", { 4U,  0U, 1U }, 1U, 0, 0 },
+        { "b", { 6U,  0U, 2U }, 2U, 0, 0 },
+        { "c", { 10U, 0U, 3U }, 3U, 0, 0 },
+    } },
+    { "constrained deadlines, density = 0.90", 5000U, 3U, {
+        { "fast", { 10U, 5U,  2U }, 2U, 0, 0 },
+        { "mid",  { 20U, 10U, 4U }, 4U, 0, 0 },
+        { "slow", { 50U, 0U,  5U }, 5U, 0, 0 },
+    } },
+    { "overload, U = 1.00 (second task refused)", 1000U, 2U, {
+        { "x", { 10U, 0U, 5U }, 5U, 0, 0 },
+        { "y", { 10U, 0U, 5U }, 5U, 0, 0 },
+    } },
+    { "budget overrun contained", 2000U, 2U, {
+        { "rogue", { 10U, 0U, 3U }, 6U, 0, 0 },
+        { "good",  { 10U, 0U, 4U }, 4U, 0, 0 },
+    } },
+};
+
+#define SIM_SET_COUNT (sizeof(sim_sets) / sizeof(sim_sets[0]))
+
+
+static void sim_task_body(void *arg) {
+    (void)arg;  /* Never runs on the host; the simulator plays the task */
+}
+
+
+static sim_task_t *sim_lookup(sim_set_t *set, const task_t *task) {
+    for (uint32_t i = 0; i < set->count; ++i) {
+        if (set->tasks[i].handle != TASK_HANDLE_INVALID &&
+            task_from_handle(set->tasks[i].handle) == task) {
+            return &set->tasks[i];
+        }
+    }
+    return NULL;
+}
+
+
+/* Returns non-zero if every admitted task that keeps its budget met all deadlines */
+static int sim_run(sim_set_t *set) {
+    host_port_init();
+
+    /* Background first, so it is task_list[0] and current after scheduler_start() */
+    int32_t background = task_create(sim_task_body, NULL, STACK_SIZE_512B);
+    if (background < 0) {
+        fprintf(stderr, "background task_create failed\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < set->count; ++i) {
+        sim_task_t *st = &set->tasks[i];
+        int32_t handle = task_create_edf(sim_task_body, st, STACK_SIZE_512B, &st->params);
+        st->handle = (handle >= 0) ? (task_handle_t)handle : TASK_HANDLE_INVALID;
+        st->remaining = st->exec_ticks;
+    }
+
+    scheduler_start();
+    host_context_switch();
+
+    uint32_t background_ticks = 0;
+    task_t *background_task = task_from_handle((task_handle_t)background);
+
+    for (uint32_t tick = 0; tick < set->ticks; ++tick) {
+        /* The current task runs for this tick, and is charged for it at the tick */
+        sim_task_t *st = sim_lookup(set, task_current);
+        if (st != NULL) {
+            st->remaining--;
+        } else if (task_current == background_task) {
+            background_ticks++;
+        }
+
+        /* A job that got its full execution time ends just before the tick */
+        if (st != NULL && st->remaining == 0) {
+            task_wait_next_period();
+            st->remaining = st->exec_ticks;
+        }
+
+        host_tick();
+        host_context_switch();
+    }
+
+    printf("\n%s: %u ticks, admitted density %.3f\n", set->name, (unsigned int)set->ticks,
+           (double)scheduler_edf_density() / EDF_DENSITY_ONE);
+    printf("  %-8s %6s %6s %6s %6s %8s %8s\n", "Task", "T", "D", "C", "Exec", "Jobs", "Misses");
+
+    int ok = 1;
+    for (uint32_t i = 0; i < set->count; ++i) {
+        sim_task_t *st = &set->tasks[i];
+        edf_state_t edf;
+
+        if (st->handle == TASK_HANDLE_INVALID || task_get_edf_stats(st->handle, &edf) != 0) {
+            printf("  %-8s %6u %6u %6u %6u  refused by admission\n", st->name,
+                   (unsigned int)st->params.period_ticks, (unsigned int)st->params.deadline_ticks,
+                   (unsigned int)st->params.budget_ticks, (unsigned int)st->exec_ticks);
+            continue;
+        }
+
+        printf("  %-8s %6u %6u %6u %6u %8u %8u", st->name,
+               (unsigned int)edf.params.period_ticks, (unsigned int)edf.params.deadline_ticks,
+               (unsigned int)edf.params.budget_ticks, (unsigned int)st->exec_ticks,
+               (unsigned int)edf.jobs, (unsigned int)edf.misses);
+        if (edf.overruns != 0) {
+            printf("  (%u overruns, throttled)", (unsigned int)edf.overruns);
+        }
+        printf("\n");
+
+        if (st->exec_ticks <= st->params.budget_ticks && edf.misses != 0) {
+            ok = 0;
+        }
+    }
+
+    printf("  background: %u ticks (%.1f%%)  ->  %s\n", (unsigned int)background_ticks,
+           100.0 * background_ticks / set->ticks, ok ? "schedulable" : "DEADLINES MISSED");
+    return ok;
+}
+
+
+int main(void) {
+    printf("EDF host simulator (tick = 1 time unit, limit %u%%)\n", (unsigned int)EDF_UTILIZATION_LIMIT_PCT);
+
+    int failed = 0;
+    for (uint32_t i = 0; i < SIM_SET_COUNT; ++i) {
+        if (!sim_run(&sim_sets[i])) {
+            failed++;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
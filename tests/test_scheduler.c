@@ -0,0 +1,410 @@
+#include "unity.h"
+#include "host_port.h"
+#include "scheduler.h"
+#include "mutex.h"
+#include "systick.h"
+
+/*
+ * Run order of the ready queues, driven through tests/host_port.c: each
+ * host_context_switch() is one PendSV, host_tick() one SysTick.
+ */
+
+static void dummy_task(void *arg) {
+    (void)arg;
+}
+
+static task_t *spawn(void) {
+    int32_t handle = task_create(dummy_task, NULL, STACK_SIZE_512B);
+    TEST_ASSERT_TRUE(handle >= 0);
+    return task_from_handle((task_handle_t)handle);
+}
+
+static task_t *next(void) {
+    host_context_switch();
+    return task_current;
+}
+
+/* File scope: mutex_init() links it into the registry for good */
+static mutex_t m;
+
+/* The blocking half of mutex_lock(); on the host a real wait returns at once */
+static void block_on(mutex_t *mutex) {
+    task_current->mutex_blocked_on = mutex;
+    task_wait_begin(&mutex->waiters, WAIT_FOREVER);
+}
+
+void setUp(void) {
+    host_port_init();
+}
+
+void tearDown(void) { }
+
+void test_equal_priorities_take_turns_in_creation_order(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    task_t *c = spawn();
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_PTR(a, task_current);
+    TEST_ASSERT_EQUAL_PTR(b, next());
+    TEST_ASSERT_EQUAL_PTR(c, next());
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_PTR(b, next());
+}
+
+void test_only_runnable_task_keeps_the_cpu(void) {
+    task_t *a = spawn();
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_INT(TASK_RUNNING, a->state);
+}
+
+void test_delete_and_gc_do_not_reorder_the_rest(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    task_t *c = spawn();
+    task_t *d = spawn();
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_PTR(b, next());
+    TEST_ASSERT_EQUAL_PTR(c, next());
+
+    /* d's slot is freed, the list shrinks, and a new task takes the slot */
+    TEST_ASSERT_EQUAL_INT(TASK_DELETE_SUCCESS, task_delete(d->handle));
+    task_garbage_collection();
+    task_t *e = spawn();
+    TEST_ASSERT_EQUAL_PTR(d, e);
+
+    /* The newcomer waits behind a and b instead of jumping in at its slot */
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_PTR(b, next());
+    TEST_ASSERT_EQUAL_PTR(e, next());
+    TEST_ASSERT_EQUAL_PTR(c, next());
+    TEST_ASSERT_EQUAL_PTR(a, next());
+}
+
+void test_switch_reaps_without_idle(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    task_t *c = spawn();
+    scheduler_start();
+
+    /* Queued by the deleter, released by the next switch */
+    TEST_ASSERT_EQUAL_INT(TASK_DELETE_SUCCESS, task_delete(b->handle));
+    TEST_ASSERT_EQUAL_INT(TASK_ZOMBIE, b->state);
+    TEST_ASSERT_EQUAL_PTR(c, next());
+    TEST_ASSERT_EQUAL_INT(TASK_UNUSED, b->state);
+    TEST_ASSERT_EQUAL_PTR(a, next());
+}
+
+void test_woken_sleeper_joins_the_back_of_its_level(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    task_t *c = spawn();
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_INT(0, task_sleep_ticks(2));
+    TEST_ASSERT_EQUAL_PTR(b, next());
+
+    host_tick();
+    TEST_ASSERT_EQUAL_PTR(c, next());
+
+    host_tick();    /* a wakes, behind b */
+    TEST_ASSERT_EQUAL_PTR(b, next());
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_PTR(c, next());
+}
+
+void test_sleep_across_tick_wrap_lasts_its_full_length(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    scheduler_start();
+
+    systick_ticks = 0xFFFFFFFEu;
+    TEST_ASSERT_EQUAL_INT(0, task_sleep_ticks(3));    /* Due at tick 1 */
+    TEST_ASSERT_EQUAL_PTR(b, next());
+
+    host_tick();
+    host_tick();    /* Tick 0 */
+    TEST_ASSERT_EQUAL_INT(TASK_BLOCKED, a->state);
+
+    host_tick();
+    TEST_ASSERT_EQUAL_INT(TASK_READY, a->state);
+}
+
+void test_highest_priority_first_and_idle_last(void) {
+    task_t *low = spawn();
+    task_t *high = spawn();
+    TEST_ASSERT_EQUAL_INT(0, task_set_priority(high->handle, TASK_PRIORITY_DEFAULT + 1));
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_PTR(high, next());
+    TEST_ASSERT_EQUAL_PTR(high, next());
+
+    task_sleep_ticks(1);
+    TEST_ASSERT_EQUAL_PTR(low, next());
+
+    task_sleep_ticks(1);
+    task_t *idle = next();
+    TEST_ASSERT_TRUE(idle->is_idle);
+    TEST_ASSERT_TRUE(next()->is_idle);
+
+    host_tick();
+    TEST_ASSERT_EQUAL_PTR(high, next());
+    TEST_ASSERT_EQUAL_INT(TASK_READY, idle->state);
+}
+
+void test_priority_change_moves_a_ready_task(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    task_t *c = spawn();
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_INT(0, task_set_priority(c->handle, TASK_PRIORITY_DEFAULT + 1));
+    TEST_ASSERT_EQUAL_PTR(c, next());
+    TEST_ASSERT_EQUAL_PTR(c, next());
+
+    /* Back down, behind the tasks already waiting there */
+    TEST_ASSERT_EQUAL_INT(0, task_set_priority(c->handle, TASK_PRIORITY_DEFAULT));
+    TEST_ASSERT_EQUAL_PTR(b, next());
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_PTR(c, next());
+}
+
+void test_blocked_tasks_are_never_picked(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_INT(0, task_block(b->handle));
+    TEST_ASSERT_EQUAL_PTR(a, next());
+    TEST_ASSERT_EQUAL_PTR(a, next());
+
+    task_block_current();
+    TEST_ASSERT_TRUE(next()->is_idle);
+    TEST_ASSERT_TRUE(next()->is_idle);
+
+    TEST_ASSERT_EQUAL_INT(0, task_unblock(b->handle));
+    TEST_ASSERT_EQUAL_PTR(b, next());
+}
+
+void test_unblock_cuts_a_sleep_short(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    scheduler_start();
+
+    task_sleep_ticks(1000);
+    TEST_ASSERT_EQUAL_PTR(b, next());
+
+    TEST_ASSERT_EQUAL_INT(0, task_unblock(a->handle));
+    TEST_ASSERT_EQUAL_UINT32(0, a->sleep_until_tick);
+    TEST_ASSERT_EQUAL_PTR(a, next());
+}
+
+void test_deleted_owner_hands_its_mutex_to_the_top_waiter(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    task_t *c = spawn();
+    mutex_init(&m, "test");
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_INT(MUTEX_OK, mutex_lock(&m));
+    host_run_as(b);
+    block_on(&m);
+    host_run_as(c);
+
+    TEST_ASSERT_EQUAL_INT(TASK_DELETE_SUCCESS, task_delete(a->handle));
+    TEST_ASSERT_EQUAL_PTR(b, m.owner);
+    TEST_ASSERT_EQUAL_PTR(&m, b->mutex_held);
+    TEST_ASSERT_NULL(b->mutex_blocked_on);
+    TEST_ASSERT_EQUAL_INT(TASK_READY, b->state);
+
+    /* Without waiters the mutex is simply free again */
+    TEST_ASSERT_EQUAL_INT(TASK_DELETE_SUCCESS, task_delete(b->handle));
+    TEST_ASSERT_NULL(m.owner);
+    TEST_ASSERT_EQUAL_INT(MUTEX_OK, mutex_trylock(&m));
+    TEST_ASSERT_EQUAL_PTR(c, m.owner);
+}
+
+void test_deleted_waiter_takes_its_priority_loan_back(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    mutex_init(&m, "test");
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_INT(MUTEX_OK, mutex_lock(&m));
+    host_run_as(b);
+    TEST_ASSERT_EQUAL_INT(0, task_set_priority(b->handle, TASK_PRIORITY_DEFAULT + 1));
+    block_on(&m);
+    task_set_effective_priority(a, b->priority);    /* The boost mutex_lock() would lend */
+    host_run_as(a);
+
+    TEST_ASSERT_EQUAL_INT(TASK_DELETE_SUCCESS, task_delete(b->handle));
+    TEST_ASSERT_EQUAL_UINT8(TASK_PRIORITY_DEFAULT, a->priority);
+    TEST_ASSERT_NULL(m.waiters.head);
+    TEST_ASSERT_EQUAL_PTR(a, m.owner);
+}
+
+void test_waiter_priority_change_reaches_the_owner(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    mutex_init(&m, "test");
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_INT(MUTEX_OK, mutex_lock(&m));
+    host_run_as(b);
+    block_on(&m);
+    host_run_as(a);
+
+    TEST_ASSERT_EQUAL_INT(0, task_set_priority(b->handle, TASK_PRIORITY_DEFAULT + 2));
+    TEST_ASSERT_EQUAL_UINT8(TASK_PRIORITY_DEFAULT + 2, a->priority);
+
+    TEST_ASSERT_EQUAL_INT(0, task_set_priority(b->handle, TASK_PRIORITY_DEFAULT));
+    TEST_ASSERT_EQUAL_UINT8(TASK_PRIORITY_DEFAULT, a->priority);
+}
+
+#if SCHEDULER_CPU_STATS
+/* Run the current task for one slice at 100 cycles per tick */
+static void run_slice(void) {
+    for (uint32_t t = 0; t < CPU_STATS_WINDOW_TICKS / CPU_STATS_WINDOW_SLICES; ++t) {
+        host_cycles += 100;
+        host_tick();
+    }
+}
+
+void test_cpu_window_slides_one_slice_at_a_time(void) {
+    task_t *a = spawn();
+    task_t *b = spawn();
+    scheduler_start();
+    const uint32_t slice = 100 * (CPU_STATS_WINDOW_TICKS / CPU_STATS_WINDOW_SLICES);
+    cpu_window_stats_t window;
+
+    run_slice();
+    scheduler_get_cpu_window(&window);
+    TEST_ASSERT_EQUAL_UINT32(slice, window.window_cycles);
+    TEST_ASSERT_EQUAL_UINT32(slice, a->run_cycles_last);
+
+    /* b takes over; a's slice stays in the window until it slides out */
+    TEST_ASSERT_EQUAL_PTR(b, next());
+    for (uint32_t i = 1; i < CPU_STATS_WINDOW_SLICES; ++i) {
+        run_slice();
+    }
+    scheduler_get_cpu_window(&window);
+    TEST_ASSERT_EQUAL_UINT32(slice * CPU_STATS_WINDOW_SLICES, window.window_cycles);
+    TEST_ASSERT_EQUAL_UINT32(slice, a->run_cycles_last);
+
+    run_slice();
+    scheduler_get_cpu_window(&window);
+    TEST_ASSERT_EQUAL_UINT32(slice * CPU_STATS_WINDOW_SLICES, window.window_cycles);
+    TEST_ASSERT_EQUAL_UINT32(0, a->run_cycles_last);
+    TEST_ASSERT_EQUAL_UINT32(slice * CPU_STATS_WINDOW_SLICES, b->run_cycles_last);
+}
+#endif
+
+#if SCHEDULER_EDF
+void test_edf_job_is_throttled_on_the_tick_that_uses_up_its_budget(void) {
+    spawn();
+    edf_params_t params = { 10U, 0U, 2U };
+    int32_t handle = task_create_edf(dummy_task, NULL, STACK_SIZE_512B, &params);
+    TEST_ASSERT_TRUE(handle >= 0);
+    task_t *edf = task_from_handle((task_handle_t)handle);
+    scheduler_start();
+
+    TEST_ASSERT_EQUAL_PTR(edf, next());
+    host_tick();
+    TEST_ASSERT_EQUAL_INT(TASK_RUNNING, edf->state);
+    host_tick();    /* Second tick of a two-tick budget */
+    TEST_ASSERT_EQUAL_INT(TASK_BLOCKED, edf->state);
+    TEST_ASSERT_NOT_EQUAL(edf, next());
+
+    edf_state_t stats;
+    TEST_ASSERT_EQUAL_INT(0, task_get_edf_stats(edf->handle, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overruns);
+}
+#endif
+
+/* Bounded wait: a task that becomes ready with n - 1 others at its level runs within n switches */
+void test_wait_is_bounded_under_create_delete_sleep_churn(void) {
+    enum { TASKS = 6, SWITCHES = 3000 };
+    task_t *tasks[TASKS];
+    uint32_t ready_since[TASKS];    /* Switch at which the current wait began, 0 = not waiting */
+
+    for (uint32_t i = 0; i < TASKS; ++i) {
+        tasks[i] = spawn();
+        ready_since[i] = 0;
+    }
+    scheduler_start();
+
+    uint32_t seed = 12345;
+    for (uint32_t step = 1; step <= SWITCHES; ++step) {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t pick = (seed >> 16) % TASKS;
+        task_t *victim = tasks[pick];
+
+        if (step % 7 == 0 && victim != task_current) {
+            /* Replace a task; its successor's wait starts now */
+            TEST_ASSERT_EQUAL_INT(TASK_DELETE_SUCCESS, task_delete(victim->handle));
+            task_garbage_collection();
+            tasks[pick] = spawn();
+            ready_since[pick] = 0;
+        } else if (step % 11 == 0) {
+            /* The running task naps through the next tick */
+            task_sleep_ticks(1);
+            host_tick();
+        }
+
+        task_t *prev = task_current;
+        task_t *cur = next();
+
+        uint32_t ready = 0;
+        for (uint32_t i = 0; i < TASKS; ++i) {
+            if (tasks[i]->state == TASK_READY || tasks[i]->state == TASK_RUNNING) {
+                ready++;
+            }
+        }
+
+        for (uint32_t i = 0; i < TASKS; ++i) {
+            if (tasks[i] == cur) {
+                /* Never twice in a row while another task was waiting */
+                if (cur == prev) {
+                    TEST_ASSERT_EQUAL_UINT32(1, ready);
+                }
+                ready_since[i] = 0;
+            } else if (tasks[i]->state == TASK_READY) {
+                if (ready_since[i] == 0) {
+                    ready_since[i] = step;
+                }
+                TEST_ASSERT_TRUE(step - ready_since[i] < TASKS);
+            } else {
+                ready_since[i] = 0;
+            }
+        }
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_equal_priorities_take_turns_in_creation_order);
+    RUN_TEST(test_only_runnable_task_keeps_the_cpu);
+    RUN_TEST(test_delete_and_gc_do_not_reorder_the_rest);
+    RUN_TEST(test_switch_reaps_without_idle);
+    RUN_TEST(test_woken_sleeper_joins_the_back_of_its_level);
+    RUN_TEST(test_sleep_across_tick_wrap_lasts_its_full_length);
+    RUN_TEST(test_highest_priority_first_and_idle_last);
+    RUN_TEST(test_priority_change_moves_a_ready_task);
+    RUN_TEST(test_blocked_tasks_are_never_picked);
+    RUN_TEST(test_unblock_cuts_a_sleep_short);
+    RUN_TEST(test_wait_is_bounded_under_create_delete_sleep_churn);
+    RUN_TEST(test_deleted_owner_hands_its_mutex_to_the_top_waiter);
+    RUN_TEST(test_deleted_waiter_takes_its_priority_loan_back);
+    RUN_TEST(test_waiter_priority_change_reaches_the_owner);
+#if SCHEDULER_CPU_STATS
+    RUN_TEST(test_cpu_window_slides_one_slice_at_a_time);
+#endif
+#if SCHEDULER_EDF
+    RUN_TEST(test_edf_job_is_throttled_on_the_tick_that_uses_up_its_budget);
+#endif
+    return UNITY_END();
+}